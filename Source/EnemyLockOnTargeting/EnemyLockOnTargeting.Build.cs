@@ -13,7 +13,10 @@ public class EnemyLockOnTargeting : ModuleRules
 			"GameplayTags", "Paper2D", "AIModule", "NavigationSystem", "UMG", "Slate", "SlateCore" });
 	
 
-		PrivateDependencyModuleNames.AddRange(new string[] {  });
+		// Added "Json", "RenderCore" for the crowd benchmark report, "SignificanceManager" for enemy tick LOD,
+		// "MassEntity", "MassCommon", "MassMovement", "MassSimulation" for background enemy proxies
+		PrivateDependencyModuleNames.AddRange(new string[] { "Json", "RenderCore", "SignificanceManager",
+			"MassEntity", "MassCommon", "MassMovement", "MassSimulation" });
 
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
@@ -7,6 +7,7 @@
 
 #include "Characters/EnemyCharacter.h"				// Enemy Character
 #include "GameFramework/PawnMovementComponent.h"	// IsFalling check
+#include "LockOnTargetingStats.h"					// Stats and CSV timers
 
 
 void UEnemyAnimInstance::NativeBeginPlay()
@@ -21,6 +22,7 @@ void UEnemyAnimInstance::NativeBeginPlay()
 void UEnemyAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
 {
 	Super::NativeUpdateAnimation(DeltaSeconds);		// Still run event for parent class
+	LOCKON_SCOPED_TIMER(STAT_LockOnEnemyAnimUpdate, GameplayAnim, EnemyAnimUpdate);
 
 	if (!EnemyCharacter) return;
 
@@ -30,3 +32,13 @@ void UEnemyAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
 	bIsFalling = EnemyCharacter->GetMovementComponent()->IsFalling();
 	bIsInCombat = EnemyCharacter->GetIsInCombat();
 }
+
+
+void UEnemyAnimInstance::ResetAnimState()
+{
+	StopAllMontages(0.0f);
+
+	ForwardSpeed = 0.0f;
+	bIsFalling = false;
+	bIsInCombat = false;
+}
@@ -7,6 +7,7 @@
 
 #include "Characters/PlayerCharacter.h"				// For APlayerCharacter
 #include "GameFramework/PawnMovementComponent.h"	// For IsFalling check
+#include "LockOnTargetingStats.h"					// For stats and CSV timers
 
 
 void UPlayerAnimInstance::NativeBeginPlay() 
@@ -20,6 +21,7 @@ void UPlayerAnimInstance::NativeBeginPlay()
 /* Gets player speed and if grounded */
 void UPlayerAnimInstance::NativeUpdateAnimation(float DeltaSeconds) {
 	Super::NativeUpdateAnimation(DeltaSeconds);		// Still run event for parent class
+	LOCKON_SCOPED_TIMER(STAT_LockOnPlayerAnimUpdate, GameplayAnim, PlayerAnimUpdate);
 	
 	if (!PlayerCharacter) return;
 
@@ -0,0 +1,373 @@
+/*
+* Author: Eyan Martucci
+* Description: Spawns crowds of enemies, drives the player through a scripted lock on routine,
+*	and writes frame time and memory results to a JSON report.
+*	Run headless with: EnemyLockOnTargeting TestLevel -game -nullrhi -LockOnBenchmark [-BenchmarkCounts=50,200,1000]
+*	or in game with the console command: LockOn.RunBenchmark 50 200 1000
+*/
+
+#include "Benchmark/CrowdBenchmarkSubsystem.h"
+
+#include "Characters/PlayerCharacter.h"			// For APlayerCharacter
+#include "Characters/EnemyCharacter.h"			// For AEnemyCharacter
+#include "Subsystems/EnemyStateTimerSubsystem.h"	// For the state timer mode in the report
+#include "Subsystems/EnemyProxySubsystem.h"		// For pausing demotion and the proxy counts in the report
+#include "Subsystems/EnemyPoolSubsystem.h"		// For spawn time histograms in the report
+#include "Subsystems/DeterministicSimSubsystem.h"	// For fixed step runs
+#include "Misc/Crc.h"							// For the state checksum
+#include "Kismet/GameplayStatics.h"				// For GetPlayerCharacter
+#include "Misc/CommandLine.h"					// For FCommandLine
+#include "Misc/Parse.h"							// For FParse
+#include "Misc/FileHelper.h"					// For SaveStringToFile
+#include "Misc/Paths.h"							// For ProjectSavedDir
+#include "HAL/PlatformMemory.h"					// For memory stats
+#include "RenderCore.h"							// For GGameThreadTime
+#include "Serialization/JsonWriter.h"			// For TJsonWriter
+#include "ProfilingDebugging/CsvProfiler.h"		// For CSV capture
+
+
+static FAutoConsoleCommandWithWorldAndArgs RunBenchmarkCommand(
+	TEXT("LockOn.RunBenchmark"),
+	TEXT("Runs the crowd benchmark for each enemy count given (default 50 200 1000)."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+
+		UCrowdBenchmarkSubsystem* benchmark = World ? World->GetSubsystem<UCrowdBenchmarkSubsystem>() : nullptr;
+		if (!benchmark) return;
+
+		TArray<int32> counts;
+		for (const FString& arg : Args)
+			counts.Add(FCString::Atoi(*arg));
+
+		benchmark->StartBenchmark(counts);
+	}));
+
+
+// Starts the benchmark automatically when launched with -LockOnBenchmark
+void UCrowdBenchmarkSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (!InWorld.IsGameWorld() || !FParse::Param(FCommandLine::Get(), TEXT("LockOnBenchmark")))
+		return;
+
+	TArray<int32> counts;
+	FString countsString;
+	if (FParse::Value(FCommandLine::Get(), TEXT("BenchmarkCounts="), countsString)) {
+		TArray<FString> countStrings;
+		countsString.ParseIntoArray(countStrings, TEXT(","));
+		for (const FString& countString : countStrings)
+			counts.Add(FCString::Atoi(*countString));
+	}
+
+	FParse::Value(FCommandLine::Get(), TEXT("BenchmarkSeconds="), RecordTime);
+
+	bExitWhenFinished = true;
+	StartBenchmark(counts);
+}
+
+
+TStatId UCrowdBenchmarkSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCrowdBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+
+// Queues every enemy count and starts the first pass
+void UCrowdBenchmarkSubsystem::StartBenchmark(const TArray<int32>& EnemyCounts) {
+
+	if (bIsRunning) return;
+
+	PlayerCharacter = Cast<APlayerCharacter>(UGameplayStatics::GetPlayerCharacter(this, 0));
+	if (!PlayerCharacter) {
+		UE_LOG(LogTemp, Error, TEXT("Crowd benchmark needs an APlayerCharacter in the level"));
+		return;
+	}
+
+	PendingCounts = EnemyCounts.Num() > 0 ? EnemyCounts : TArray<int32>{ 50, 200, 1000 };
+	Results.Reset();
+	bIsRunning = true;
+
+	if (UEnemyPoolSubsystem* pool = GetWorld()->GetSubsystem<UEnemyPoolSubsystem>())
+		pool->ResetHistograms();
+
+	// Roaming carries enemies past the demote radius, which would shrink the crowd being measured
+	if (UEnemyProxySubsystem* proxies = GetWorld()->GetSubsystem<UEnemyProxySubsystem>())
+		proxies->SetDemotionPaused(true);
+
+	// *** Capture Per-Subsystem Timings to CSV
+#if CSV_PROFILER
+	if (!FCsvProfiler::Get()->IsCapturing()) {
+		FCsvProfiler::Get()->BeginCapture(-1, FPaths::ProjectSavedDir() / TEXT("Benchmarks"));
+		bStartedCsvCapture = true;
+	}
+#endif
+
+	StartNextCount();
+}
+
+
+void UCrowdBenchmarkSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	if (!bIsRunning) return;
+
+	PhaseTimer += DeltaTime;
+
+	switch (Phase) {
+
+		case EBenchmarkPhase::Spawning:
+			SpawnBatch();
+			break;
+
+		case EBenchmarkPhase::Warmup:
+			if (PhaseTimer >= WarmupTime) {
+				Phase = EBenchmarkPhase::Recording;
+				PhaseTimer = 0.0f;
+				LastFrameRealTime = FPlatformTime::Seconds();
+				CSV_EVENT_GLOBAL(TEXT("BenchmarkRecord_%d"), SpawnedEnemies.Num());
+			}
+			break;
+
+		case EBenchmarkPhase::Recording: {
+			const double now = FPlatformTime::Seconds();
+			FrameSamplesMs.Add(UDeterministicSimSubsystem::IsEnabled() ? (float)((now - LastFrameRealTime) * 1000.0) : DeltaTime * 1000.0f);
+			LastFrameRealTime = now;
+			GameThreadSamplesMs.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+			DriveScriptedPlayer(DeltaTime);
+
+			if (PhaseTimer >= RecordTime)		// Simulated time, so deterministic runs record the same frames
+				FinishCount();
+			break;
+		}
+	}
+}
+
+
+// Resets state for the next enemy count
+void UCrowdBenchmarkSubsystem::StartNextCount() {
+
+	DestroySpawnedEnemies();
+	FrameSamplesMs.Reset();
+	GameThreadSamplesMs.Reset();
+	SpawnStream.Initialize(PendingCounts[0]);
+	Phase = EBenchmarkPhase::Spawning;
+	PhaseTimer = 0.0f;
+	ScriptTimer = 0.0f;
+	ScriptStep = 0;
+}
+
+
+// Spawns part of the current enemy count using the same path as the player's spawn input
+void UCrowdBenchmarkSubsystem::SpawnBatch() {
+
+	const int32 targetCount = PendingCounts[0];
+	const FVector center = PlayerCharacter->GetActorLocation();
+
+	for (int32 i = 0; i < MaxSpawnsPerFrame && SpawnedEnemies.Num() < targetCount; i++) {
+
+		// *** Pick a Point Inside the Spawn Radius
+		FVector offset = SpawnStream.GetUnitVector().GetSafeNormal2D() * SpawnStream.FRandRange(300.0f, SpawnRadius);
+		FVector spawnLoc = center + offset + FVector(0.0f, 0.0f, 100.0f);
+
+		if (AEnemyCharacter* enemy = PlayerCharacter->SpawnEnemyAtLocation(spawnLoc))
+			SpawnedEnemies.Add(enemy);
+		else
+			PendingCounts[0]--;		// Count failed spawns so the phase still finishes
+	}
+
+	if (SpawnedEnemies.Num() >= PendingCounts[0]) {
+		Phase = EBenchmarkPhase::Warmup;
+		PhaseTimer = 0.0f;
+	}
+}
+
+
+// Despawns the enemies from the previous pass (back into the enemy pool when it is enabled)
+void UCrowdBenchmarkSubsystem::DestroySpawnedEnemies() {
+
+	for (AEnemyCharacter* enemy : SpawnedEnemies) {
+		if (IsValid(enemy))
+			enemy->Despawn();
+	}
+
+	SpawnedEnemies.Reset();
+}
+
+
+// Repeats a 2 second routine of lock on, switching right and left, attacking, and releasing lock on
+void UCrowdBenchmarkSubsystem::DriveScriptedPlayer(float DeltaTime) {
+
+	static const float stepTimes[] = { 0.0f, 0.5f, 0.9f, 1.2f, 1.6f };
+	static const int32 numSteps = UE_ARRAY_COUNT(stepTimes);
+	static const float cycleLength = 2.0f;
+
+	ScriptTimer += DeltaTime;
+
+	// *** Run Every Step Whose Time Has Passed
+	while (ScriptStep < numSteps && ScriptTimer >= stepTimes[ScriptStep]) {
+
+		switch (ScriptStep) {
+			case 0: PlayerCharacter->StartLockOnTargeting(); break;
+			case 1: PlayerCharacter->SwitchToRightTarget(); break;
+			case 2: PlayerCharacter->SwitchToLeftTarget(); break;
+			case 3: PlayerCharacter->Attack(); break;
+			case 4: PlayerCharacter->StopLockOnTargeting(); break;
+		}
+		ScriptStep++;
+	}
+
+	// *** Restart Cycle
+	if (ScriptTimer >= cycleLength) {
+		ScriptTimer -= cycleLength;
+		ScriptStep = 0;
+	}
+}
+
+
+// Summarizes the recorded samples and moves to the next enemy count
+void UCrowdBenchmarkSubsystem::FinishCount() {
+
+	if (PlayerCharacter->IsTargetingInputHeld())
+		PlayerCharacter->StopLockOnTargeting();
+
+	// *** Summarize Samples
+	FCrowdBenchmarkResult result;
+	result.EnemyCount = SpawnedEnemies.Num();
+	result.NumFrames = FrameSamplesMs.Num();
+
+	if (result.NumFrames > 0) {
+		TArray<float> sortedFrames = FrameSamplesMs;
+		TArray<float> sortedGameThread = GameThreadSamplesMs;
+		sortedFrames.Sort();
+		sortedGameThread.Sort();
+
+		auto percentile = [](const TArray<float>& sorted, float pct) {
+			return sorted[FMath::Clamp(FMath::FloorToInt32(pct * (sorted.Num() - 1)), 0, sorted.Num() - 1)];
+		};
+
+		float frameSum = 0.0f;
+		for (float sample : sortedFrames) frameSum += sample;
+		float gameThreadSum = 0.0f;
+		for (float sample : sortedGameThread) gameThreadSum += sample;
+
+		result.AvgFrameMs = frameSum / result.NumFrames;
+		result.P50FrameMs = percentile(sortedFrames, 0.50f);
+		result.P95FrameMs = percentile(sortedFrames, 0.95f);
+		result.P99FrameMs = percentile(sortedFrames, 0.99f);
+		result.MaxFrameMs = sortedFrames.Last();
+		result.AvgGameThreadMs = gameThreadSum / result.NumFrames;
+		result.P95GameThreadMs = percentile(sortedGameThread, 0.95f);
+	}
+
+	result.UsedPhysicalMB = FPlatformMemory::GetStats().UsedPhysical / (1024.0f * 1024.0f);
+
+	if (UEnemyProxySubsystem* proxies = GetWorld()->GetSubsystem<UEnemyProxySubsystem>())
+		result.ProxyCount = proxies->GetNumProxies();
+
+	// *** Checksum Enemy Locations in Spawn Order
+	for (const AEnemyCharacter* enemy : SpawnedEnemies) {
+		if (!IsValid(enemy) || enemy->IsInPool()) continue;
+		result.ActiveActorCount++;
+		const FVector location = enemy->GetActorLocation();
+		result.StateChecksum = FCrc::MemCrc32(&location, sizeof(location), result.StateChecksum);
+	}
+	Results.Add(result);
+
+	UE_LOG(LogTemp, Display, TEXT("Crowd benchmark %d enemies (%d actors, %d proxies): avg %.2fms p95 %.2fms game thread %.2fms checksum %08x"),
+		result.EnemyCount, result.ActiveActorCount, result.ProxyCount, result.AvgFrameMs, result.P95FrameMs, result.AvgGameThreadMs, result.StateChecksum);
+
+	// *** Start Next Count or Finish
+	PendingCounts.RemoveAt(0);
+
+	if (PendingCounts.Num() > 0) {
+		StartNextCount();
+		return;
+	}
+
+	DestroySpawnedEnemies();
+	WriteReport();
+	bIsRunning = false;
+
+	if (UEnemyProxySubsystem* proxies = GetWorld()->GetSubsystem<UEnemyProxySubsystem>())
+		proxies->SetDemotionPaused(false);
+
+#if CSV_PROFILER
+	if (bStartedCsvCapture) {
+		FCsvProfiler::Get()->EndCapture();
+		bStartedCsvCapture = false;
+	}
+#endif
+
+	if (bExitWhenFinished)
+		FPlatformMisc::RequestExit(false);
+}
+
+
+// Writes results to Saved/Benchmarks as JSON
+void UCrowdBenchmarkSubsystem::WriteReport() const {
+
+	FString json;
+	TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&json);
+
+	writer->WriteObjectStart();
+	writer->WriteValue(TEXT("map"), GetWorld()->GetMapName());
+	writer->WriteValue(TEXT("recordSeconds"), RecordTime);
+	writer->WriteValue(TEXT("stateTimerMode"), (int32)UEnemyStateTimerSubsystem::GetTimerMode());
+	writer->WriteValue(TEXT("enemyProxies"), UEnemyProxySubsystem::IsEnabled());
+	writer->WriteValue(TEXT("enemyPool"), UEnemyPoolSubsystem::IsEnabled());
+
+	const UDeterministicSimSubsystem* deterministicSim = GetWorld()->GetSubsystem<UDeterministicSimSubsystem>();
+	writer->WriteValue(TEXT("deterministic"), UDeterministicSimSubsystem::IsEnabled());
+	if (deterministicSim && UDeterministicSimSubsystem::IsEnabled()) {
+		writer->WriteValue(TEXT("seed"), (int64)deterministicSim->GetSeed());
+		writer->WriteValue(TEXT("fixedDeltaTime"), deterministicSim->GetFixedDeltaTime());
+	}
+
+	// *** Spawn Time Histograms (bins are [minMs, next bin's minMs))
+	if (const UEnemyPoolSubsystem* pool = GetWorld()->GetSubsystem<UEnemyPoolSubsystem>()) {
+
+		auto writeHistogram = [&writer](const TCHAR* name, const FHistogram& histogram) {
+			writer->WriteArrayStart(name);
+			for (int32 bin = 0; bin < histogram.GetNumBins(); bin++) {
+				writer->WriteObjectStart();
+				writer->WriteValue(TEXT("minMs"), histogram.GetBinLowerBound(bin));
+				writer->WriteValue(TEXT("count"), histogram.GetBinObservationsCount(bin));
+				writer->WriteObjectEnd();
+			}
+			writer->WriteArrayEnd();
+		};
+
+		writer->WriteObjectStart(TEXT("spawnHistograms"));
+		writeHistogram(TEXT("spawnActor"), pool->GetSpawnActorHistogram());
+		writeHistogram(TEXT("pooled"), pool->GetPooledHistogram());
+		writer->WriteObjectEnd();
+	}
+
+	writer->WriteArrayStart(TEXT("results"));
+
+	for (const FCrowdBenchmarkResult& result : Results) {
+		writer->WriteObjectStart();
+		writer->WriteValue(TEXT("enemyCount"), result.EnemyCount);
+		writer->WriteValue(TEXT("activeActors"), result.ActiveActorCount);
+		writer->WriteValue(TEXT("proxies"), result.ProxyCount);
+		writer->WriteValue(TEXT("frames"), result.NumFrames);
+		writer->WriteValue(TEXT("avgFrameMs"), result.AvgFrameMs);
+		writer->WriteValue(TEXT("p50FrameMs"), result.P50FrameMs);
+		writer->WriteValue(TEXT("p95FrameMs"), result.P95FrameMs);
+		writer->WriteValue(TEXT("p99FrameMs"), result.P99FrameMs);
+		writer->WriteValue(TEXT("maxFrameMs"), result.MaxFrameMs);
+		writer->WriteValue(TEXT("avgGameThreadMs"), result.AvgGameThreadMs);
+		writer->WriteValue(TEXT("p95GameThreadMs"), result.P95GameThreadMs);
+		writer->WriteValue(TEXT("usedPhysicalMB"), result.UsedPhysicalMB);
+		writer->WriteValue(TEXT("stateChecksum"), FString::Printf(TEXT("%08x"), result.StateChecksum));
+		writer->WriteObjectEnd();
+	}
+
+	writer->WriteArrayEnd();
+	writer->WriteObjectEnd();
+	writer->Close();
+
+	FString path = FPaths::ProjectSavedDir() / TEXT("Benchmarks") /
+		FString::Printf(TEXT("LockOnBenchmark-%s.json"), *FDateTime::Now().ToString());
+	FFileHelper::SaveStringToFile(json, *path);
+
+	UE_LOG(LogTemp, Display, TEXT("Crowd benchmark report written to %s"), *path);
+}
@@ -13,6 +13,11 @@
 #include "Kismet/GameplayStatics.h"						// Apply Damage
 #include "Characters/PlayerCharacter.h"					// Player Character
 #include "Components/WidgetComponent.h"					// Widget Component
+#include "Subsystems/TargetableRegistry.h"				// Targetable Registry
+#include "Subsystems/EnemyProxySubsystem.h"				// Enemy Proxy Subsystem
+#include "Subsystems/EnemyPoolSubsystem.h"				// Enemy Pool Subsystem
+#include "Subsystems/ScreenProjectionSubsystem.h"		// Screen Projection Subsystem
+#include "LockOnTargetingStats.h"						// Montage play stat
 
 // Sets default values
 AEnemyCharacter::AEnemyCharacter()
@@ -67,6 +72,74 @@ void AEnemyCharacter::BeginPlay()
 	// Bind functions
 	SwordCollision->OnComponentBeginOverlap.AddDynamic(this, &AEnemyCharacter::OnSwordBeginOverlap);
 	EnemyAnimInstance->OnMontageEnded.AddDynamic(this, &AEnemyCharacter::OnMontageEnd);
+
+	// Get Subsystems
+	TargetableRegistry = GetWorld()->GetSubsystem<UTargetableRegistry>();
+	TickLODSubsystem = GetWorld()->GetSubsystem<UEnemyTickLODSubsystem>();
+	ProxySubsystem = GetWorld()->GetSubsystem<UEnemyProxySubsystem>();
+	EnemyPool = GetWorld()->GetSubsystem<UEnemyPoolSubsystem>();
+	ScreenProjection = GetWorld()->GetSubsystem<UScreenProjectionSubsystem>();
+
+	RegisterWithSubsystems();
+}
+
+// Called when the enemy is destroyed or removed from the level
+void AEnemyCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (!bIsInPool)		// Pooled enemies already unregistered
+		UnregisterFromSubsystems();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+void AEnemyCharacter::SetGameplayTags(const FGameplayTagContainer& NewTags) {
+
+	GameplayTags = NewTags;
+
+	if (TargetableRegistry && !bIsInPool)		// Pooled enemies register their tags again when reused
+		TargetableRegistry->UpdateTargetTags(this, GameplayTags);
+}
+
+
+void AEnemyCharacter::RegisterWithSubsystems() {
+
+	// Register as a target so lock on targeting can find this enemy without an overlap query
+	if (TargetableRegistry) {
+		TargetableRegistry->RegisterTarget(this, GameplayTags);
+		TargetableRegistry->SetTargetThreat(this, GetIsInCombat() ? 1.0f : 0.0f);
+		GetCapsuleComponent()->TransformUpdated.AddUObject(this, &AEnemyCharacter::OnRootTransformUpdated);
+	}
+
+	// Let the significance manager decide how often this enemy ticks
+	if (TickLODSubsystem)
+		TickLODSubsystem->RegisterEnemy(this);
+
+	// Let far away roaming enemies be swapped for Mass entities
+	if (ProxySubsystem)
+		ProxySubsystem->RegisterEnemy(this);
+
+	// Hide the healthbar while off screen, using the projection of this frame's registered targets
+	if (ScreenProjection)
+		ScreenProjection->RegisterCulledComponent(this, WidgetComp);
+}
+
+
+void AEnemyCharacter::UnregisterFromSubsystems() {
+
+	if (TargetableRegistry) {
+		TargetableRegistry->UnregisterTarget(this);
+		GetCapsuleComponent()->TransformUpdated.RemoveAll(this);
+	}
+
+	if (TickLODSubsystem)
+		TickLODSubsystem->UnregisterEnemy(this);
+
+	if (ProxySubsystem)
+		ProxySubsystem->UnregisterEnemy(this);
+
+	if (ScreenProjection)
+		ScreenProjection->UnregisterCulledComponent(this);
 }
 
 // Called every frame
@@ -88,6 +161,9 @@ void AEnemyCharacter::SwitchMoveState(EEnemyMoveState newState) {
 
 	CurState = newState;
 
+	if (TargetableRegistry)		// Lock on threat selection policy prefers enemies in combat
+		TargetableRegistry->SetTargetThreat(this, GetIsInCombat() ? 1.0f : 0.0f);
+
 	switch (CurState) {
 
 		case EEnemyMoveState::Roaming:
@@ -117,6 +193,7 @@ void AEnemyCharacter::StartAttacking()
 	bHasAttacked = true;
 	bHasDoneDamage = false;
 	EnemyAnimInstance->Montage_Play(AttackMontage);		// Play attack montage
+	LOCKON_COUNT_MONTAGE_PLAY();
 }
 
 
@@ -163,11 +240,107 @@ void AEnemyCharacter::OnMontageEnd(UAnimMontage* Montage, bool bInterrupted)
 }
 
 
+// Sets the tick interval of this enemy and its AI controller for the new LOD.
+//	Ticks with an interval still receive the full elapsed time as DeltaTime.
+void AEnemyCharacter::SetTickLOD(EEnemyTickLOD NewLOD) {
+
+	if (!TickLODSubsystem) return;
+
+	float tickInterval = TickLODSubsystem->GetTickInterval(NewLOD);
+	SetActorTickInterval(tickInterval);
+
+	if (IsValid(EnemyAIController))
+		EnemyAIController->SetActorTickInterval(tickInterval);
+}
+
+
 // Called when enemy dies, disables movement and enemy AI
 void AEnemyCharacter::StopMovementOnDeath() {
 
 	GetCharacterMovement()->DisableMovement();
 
 	EnemyAIController->StopMovement();
-	DetachFromControllerPendingDestroy();
+
+	// Pooled enemies keep their controller so reusing them doesn't spawn and possess a new one
+	if (EnemyPool && UEnemyPoolSubsystem::IsEnabled())
+		EnemyAIController->DeactivateAI();
+	else
+		DetachFromControllerPendingDestroy();
+}
+
+
+// Leaves the targetable registry, registered again when reused from the pool
+void AEnemyCharacter::StopBeingTargetable() {
+
+	if (TargetableRegistry)
+		TargetableRegistry->UnregisterTarget(this);
+}
+
+
+void AEnemyCharacter::Despawn() {
+
+	if (EnemyPool)
+		EnemyPool->ReleaseEnemy(this);
+	else
+		Destroy();
+}
+
+
+// Hides the enemy and stops everything that ticks or collides until it is acquired again
+void AEnemyCharacter::OnReleasedToPool() {
+
+	bIsInPool = true;		// Set first, stopping montages below can call back into Despawn
+	UnregisterFromSubsystems();
+
+	if (IsValid(EnemyAIController))
+		EnemyAIController->DeactivateAI();
+
+	// *** Stop Animation and Combat
+	EnemyAnimInstance->StopAllMontages(0.0f);
+	DisableAttackCollision();
+	bHasAttacked = false;
+	bHasDoneDamage = false;
+
+	// *** Hide and Stop Ticking
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->DisableMovement();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+	GetMesh()->SetComponentTickEnabled(false);
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+}
+
+
+// Resets the enemy to how it looks after a fresh spawn, then starts its AI
+void AEnemyCharacter::OnAcquiredFromPool(const FVector& Location, const FRotator& Rotation) {
+
+	TeleportTo(Location, Rotation, false, true);
+
+	// *** Reset Components
+	HealthComponent->ResetHealth();
+	EnemyAnimInstance->ResetAnimState();
+	SwitchMoveState(EEnemyMoveState::Roaming);
+
+	// *** Show and Start Ticking
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+	GetMesh()->SetComponentTickEnabled(true);
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+	GetCharacterMovement()->SetDefaultMovementMode();
+
+	bIsInPool = false;
+	RegisterWithSubsystems();
+
+	if (IsValid(EnemyAIController))
+		EnemyAIController->ActivateAI();
+}
+
+
+// Pushes the new capsule location to the targetable registry
+void AEnemyCharacter::OnRootTransformUpdated(USceneComponent* UpdatedComponent,
+	EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	TargetableRegistry->UpdateTargetLocation(this, UpdatedComponent->GetComponentLocation());
 }
\ No newline at end of file
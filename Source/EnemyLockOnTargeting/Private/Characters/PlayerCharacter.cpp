@@ -16,6 +16,9 @@
 #include "Perception/AIPerceptionStimuliSourceComponent.h"	// Perception (for AI detection)
 #include "Perception/AISense_Sight.h"						// Perception (for AI detection)
 #include "Kismet/GameplayStatics.h"						// To Restart Level
+#include "LockOnTargetingStats.h"						// Stats and CSV timers
+#include "Subsystems/EnemyPoolSubsystem.h"				// Enemy Pool
+#include "Subsystems/InputLatencySubsystem.h"			// Input Latency
 
 
 // Sets default values
@@ -73,6 +76,12 @@ void APlayerCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 	
+	// Fill the enemy pool during level load instead of on the first spawns
+	EnemyPool = GetWorld()->GetSubsystem<UEnemyPoolSubsystem>();
+	if (EnemyPool)
+		EnemyPool->Prewarm(EnemyToSpawn, EnemyPoolPrewarmCount, GetActorLocation());
+
+	InputLatency = GetWorld()->GetSubsystem<UInputLatencySubsystem>();
 
 	APlayerController* PC = Cast<APlayerController>(Controller);
 	if (!PC) return;
@@ -88,6 +97,7 @@ void APlayerCharacter::BeginPlay()
 void APlayerCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+	LOCKON_SCOPED_TIMER(STAT_LockOnPlayerTick, LockOnTargeting, PlayerTick);
 
 	if(bIsMoveInputAllowed)
 		UpdatePlayerRotation();
@@ -120,6 +130,9 @@ void APlayerCharacter::UpdatePlayerRotation() {
 		FRotator newRotation = FMath::RInterpTo(GetActorRotation(),
 			targetRotation, GetWorld()->GetDeltaSeconds(), RotationLerp);
 		SetActorRotation(newRotation);
+
+		if (InputLatency)
+			InputLatency->MarkConsumed(ELockOnLatencyConsumer::PlayerRotation);
 	}
 	// *** Rotate to Move Direction
 	else if (!bIsHoldingTargetingInput) {
@@ -300,6 +313,9 @@ void APlayerCharacter::Look(const FInputActionValue& Value) {
 void APlayerCharacter::StartLockOnTargeting() {
 	bIsHoldingTargetingInput = true;
 
+	if (InputLatency)
+		InputLatency->BeginInput();		// Camera, arrow and rotation latency is measured from here
+
 	LockOnTargetingComp->OnTargetingInputStart();
 }
 
@@ -349,10 +365,21 @@ void APlayerCharacter::SpawnEnemy() {
 	// *** Spawn Enemy
 	FVector spawnLoc = GetActorLocation() +		// Spawn in camera forward direction in the air
 		(Camera->GetForwardVector().GetSafeNormal2D() * EnemySpawnDistance) + (GetActorUpVector() * 100.0f);
-	FActorSpawnParameters SpawnParams;
-	AEnemyCharacter* newEnemy = GetWorld()->SpawnActor<AEnemyCharacter>(EnemyToSpawn,	spawnLoc, GetActorRotation(), SpawnParams);
+	AEnemyCharacter* newEnemy = SpawnEnemyAtLocation(spawnLoc);
 
 	// Check if Spawn Worked
 	if (!newEnemy && GEngine)
 		GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Enemy failed to spawn in PlayerCharacter->SpawnEnemy"));
+}
+
+// Spawns an enemy at the given location facing the same direction as the player, reusing a pooled one when possible
+AEnemyCharacter* APlayerCharacter::SpawnEnemyAtLocation(const FVector& SpawnLocation) {
+
+	if (!EnemyToSpawn) return nullptr;
+
+	if (EnemyPool)
+		return EnemyPool->AcquireEnemy(EnemyToSpawn, SpawnLocation, GetActorRotation());
+
+	FActorSpawnParameters SpawnParams;
+	return GetWorld()->SpawnActor<AEnemyCharacter>(EnemyToSpawn, SpawnLocation, GetActorRotation(), SpawnParams);
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 
 #include "Characters/EnemyCharacter.h"		// Enemy Character
 #include "Animation/EnemyAnimInstance.h"	// Enemy Anim Instance
+#include "LockOnTargetingStats.h"			// Montage play stat
 
 
 // Sets default values for this component's properties
@@ -40,6 +41,25 @@ void UEnemyHealth::TickComponent(float DeltaTime, ELevelTick TickType, FActorCom
 }
 
 
+// Sets health without playing hurt or death montages
+void UEnemyHealth::SetHealth(float NewHealth) {
+
+	Health = FMath::Clamp(NewHealth, 0.0f, MaxHealth);
+
+	if (EnemyCharacter && EnemyCharacter->GetHealthbarWidget())
+		EnemyCharacter->GetHealthbarWidget()->SetBarValuePercent(Health / MaxHealth);
+}
+
+
+void UEnemyHealth::ResetHealth() {
+
+	SetHealth(MaxHealth);
+
+	if (EnemyCharacter && EnemyCharacter->GetHealthbarWidget())
+		EnemyCharacter->GetHealthbarWidget()->HideHealthbar();
+}
+
+
 // Subscribed to Owner Actor's OnTakeAnyDamage event. Reduces health and checks if enemy is eliminated.
 void UEnemyHealth::OnTakeDamage(AActor* DamagedActor, float Damage, const UDamageType* DamageType, 
 	AController* InstigatedBy, AActor* DamageCauser)
@@ -52,6 +72,7 @@ void UEnemyHealth::OnTakeDamage(AActor* DamagedActor, float Damage, const UDamag
 
 		Health -= Damage;
 		EnemyAnimInstance->Montage_Play(HurtMontage);			// Play hurt montage
+		LOCKON_COUNT_MONTAGE_PLAY();
 
 		EnemyCharacter->GetHealthbarWidget()->ShowHealthbar();	// Show healthbar
 		EnemyCharacter->GetHealthbarWidget()->SetBarValuePercent(Health / MaxHealth);	// Update healthbar value
@@ -61,18 +82,20 @@ void UEnemyHealth::OnTakeDamage(AActor* DamagedActor, float Damage, const UDamag
 	else {
 		Health = 0;
 		EnemyCharacter->StopMovementOnDeath();					// Disable movement
+		EnemyCharacter->StopBeingTargetable();					// Lock on moves to the next target
 		EnemyAnimInstance->Montage_Play(DeathMontage);			// Start death montage
+		LOCKON_COUNT_MONTAGE_PLAY();
 
 		EnemyCharacter->GetHealthbarWidget()->HideHealthbar();	// Hide healthbar
 	}
 }
 
 
-// Cleanup after montage ends, destroys enemy when death montage is finished
+// Cleanup after montage ends, despawns enemy when death montage is finished
 void UEnemyHealth::OnMontageEnd(UAnimMontage* Montage, bool bInterrupted) {
 
-	if (Montage == DeathMontage)					// If death montage ended, destroy enemy
-		GetOwner()->Destroy();
+	if (Montage == DeathMontage && EnemyCharacter)	// If death montage ended, return enemy to the pool
+		EnemyCharacter->Despawn();
 	
 	if (bInterrupted && EnemyCharacter)				// If montage was interrupted
 		EnemyCharacter->DisableAttackCollision();	// Disable attack collision incase attack was interrupted
@@ -6,15 +6,47 @@
 
 #include "Components/LockOnTargeting.h"
 
-#include "Kismet/KismetSystemLibrary.h"			// For SphereOverlapActors
-#include "GameplayTagAssetInterface.h"			// For IGameplayTagAssetInterface
 #include "GameplayTagContainer.h"				// For FGameplayTag
 #include "GameFramework/Actor.h"				// For AActor
 #include "Engine/World.h"						// For GetWorld()
 #include "GameFramework/SpringArmComponent.h"	// For Spring Arm
 #include "Camera/CameraComponent.h"				// For Camera
 #include "Kismet/GameplayStatics.h"				// For GetPlayerController
+#include "GameFramework/CharacterMovementComponent.h"	// For the player movement tick
+#include "HAL/IConsoleManager.h"				// For console variables and commands
 #include "UI/TargetingArrow.h"					// For TargetingArrow Actor
+#include "Subsystems/TargetableRegistry.h"		// For UTargetableRegistry
+#include "Subsystems/InputLatencySubsystem.h"	// For UInputLatencySubsystem
+#include "Subsystems/ScreenProjectionSubsystem.h"	// For cached screen positions
+#include "Targeting/TargetScoringPolicies.h"	// For selection policy scorers
+#include "LockOnTargetingStats.h"				// For targeting stats and LLM tag
+
+
+static TAutoConsoleVariable<bool> CVarExplicitTickOrder(
+	TEXT("LockOn.ExplicitTickOrder"), true,
+	TEXT("If true, targeting ticks after the player has moved and rotated, before the spring arm, and the arrow ticks after the camera update.\n")
+	TEXT("Read when the targeting component begins play, compare with LockOn.DumpInputLatency."));
+
+static TAutoConsoleVariable<bool> CVarUseTargetRanking(
+	TEXT("LockOn.UseTargetRanking"), true,
+	TEXT("If true, lock on input and directional switches read the continuously ranked targets instead of running a selection query."));
+
+static TAutoConsoleVariable<bool> CVarUseAngularTargetRing(
+	TEXT("LockOn.UseAngularTargetRing"), true,
+	TEXT("If true, directional switches pick the neighboring target by yaw around the player (with wraparound) from the ranked ring.\n")
+	TEXT("Otherwise the nearest lateral offset from the player's right vector is used. Needs LockOn.UseTargetRanking."));
+
+static FAutoConsoleCommandWithWorldAndArgs DumpTickOrderCommand(
+	TEXT("LockOn.DumpTickOrder"),
+	TEXT("Logs the resolved tick groups and prerequisites of the player, lock on targeting, spring arm and targeting arrow."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+
+		APawn* playerPawn = World ? UGameplayStatics::GetPlayerPawn(World, 0) : nullptr;
+		ULockOnTargeting* targeting = playerPawn ? playerPawn->FindComponentByClass<ULockOnTargeting>() : nullptr;
+		if (targeting)
+			targeting->DumpTickOrder();
+	}));
+
 
 // Sets default values for this component's properties
 ULockOnTargeting::ULockOnTargeting()
@@ -43,12 +75,111 @@ void ULockOnTargeting::BeginPlay()
 	Camera = PlayerActor->FindComponentByClass<UCameraComponent>();
 	DefaultSpringArmLength = SpringArm->TargetArmLength;
 	PlayerController = UGameplayStatics::GetPlayerController(this, 0);
+	TargetableRegistry = GetWorld()->GetSubsystem<UTargetableRegistry>();
+	TargetableRegistry->SetGridCellSize(MaxTargetingDistance);	// Targeting sphere diameter fits in 2x2 cells
+	TargetableTagMask = TargetableRegistry->GetTagQueryMask(TargetableTag);
+	InputLatency = GetWorld()->GetSubsystem<UInputLatencySubsystem>();
+	ScreenProjection = GetWorld()->GetSubsystem<UScreenProjectionSubsystem>();
+
+	// *** Setup Line of Sight Cache
+	VisibilityCache.TimeToLive = VisibilityTimeToLive;
+	VisibilityCache.InvalidateDistance = VisibilityInvalidateDistance;
+	VisibilityCache.TraceChannel = VisibilityTraceChannel;
+	VisibilityTraceDelegate.BindUObject(this, &ULockOnTargeting::OnVisibilityTraceDone);
 
 	// *** Spawn Targeting Arrow
 	FActorSpawnParameters SpawnParams;
 	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
 	TargetingArrow = GetWorld()->SpawnActor<ATargetingArrow>(TargetingArrowClass, 
 		FVector::ZeroVector, FRotator::ZeroRotator,SpawnParams);
+
+	if (CVarExplicitTickOrder.GetValueOnGameThread())
+		SetupTickOrder();
+}
+
+
+// Orders the ticks so every system reads this frame's final data once
+void ULockOnTargeting::SetupTickOrder() {
+
+	// *** Targeting Reads the Moved and Rotated Player (UpdatePlayerRotation runs in the player's tick)
+	SetTickGroup(TG_PostPhysics);
+	AddTickPrerequisiteActor(PlayerActor);
+	if (UCharacterMovementComponent* movement = PlayerActor->FindComponentByClass<UCharacterMovementComponent>())
+		AddTickPrerequisiteComponent(movement);
+
+	// *** Spring Arm Applies the Offset, Length and Control Rotation Set in UpdateTargeting
+	SpringArm->SetTickGroup(TG_PostPhysics);
+	SpringArm->AddTickPrerequisiteComponent(this);
+
+	// *** Arrow Runs After the Camera Manager Update (between TG_PostPhysics and TG_PostUpdateWork)
+	if (TargetingArrow) {
+		TargetingArrow->SetTickGroup(TG_PostUpdateWork);
+		TargetingArrow->AddTickPrerequisiteComponent(this);
+	}
+}
+
+
+void ULockOnTargeting::DumpTickOrder() {
+
+	// *** Gather Tick Functions
+	TArray<TPair<FString, FTickFunction*>, TInlineAllocator<8>> ticks;
+	ticks.Emplace(TEXT("Player (UpdatePlayerRotation)"), &PlayerActor->PrimaryActorTick);
+	if (UCharacterMovementComponent* movement = PlayerActor->FindComponentByClass<UCharacterMovementComponent>())
+		ticks.Emplace(TEXT("Player Movement"), &movement->PrimaryComponentTick);
+	ticks.Emplace(TEXT("Lock On Targeting"), &PrimaryComponentTick);
+	ticks.Emplace(TEXT("Spring Arm"), &SpringArm->PrimaryComponentTick);
+	if (ScreenProjection)
+		ticks.Emplace(TEXT("Screen Projection Cache"), &ScreenProjection->GetTickFunction());
+	if (TargetingArrow)
+		ticks.Emplace(TEXT("Targeting Arrow"), &TargetingArrow->PrimaryActorTick);
+
+	// *** Sort by Tick Group (prerequisites can push a tick into a later group), Then by Prerequisite Depth Within the Group
+	TFunction<int32(FTickFunction*, int32)> getDepth = [&getDepth](FTickFunction* tick, int32 guard) {
+		int32 depth = 0;
+		if (guard > 16) return depth;		// Prerequisite cycles are reported by the engine, just stop here
+
+		for (FTickPrerequisite& prerequisite : tick->GetPrerequisites()) {
+			if (FTickFunction* prerequisiteTick = prerequisite.Get())
+				depth = FMath::Max(depth, getDepth(prerequisiteTick, guard + 1) + 1);
+		}
+		return depth;
+	};
+
+	ticks.StableSort([&getDepth](const TPair<FString, FTickFunction*>& a, const TPair<FString, FTickFunction*>& b) {
+		const ETickingGroup groupA = a.Value->GetActualTickGroup();
+		const ETickingGroup groupB = b.Value->GetActualTickGroup();
+		if (groupA != groupB) return groupA < groupB;
+		return getDepth(a.Value, 0) < getDepth(b.Value, 0);
+	});
+
+	// *** Log Resolved Order
+	const UEnum* tickGroupEnum = StaticEnum<ETickingGroup>();
+	bool bLoggedCameraUpdate = false;
+
+	UE_LOG(LogTemp, Display, TEXT("Lock on tick order (LockOn.ExplicitTickOrder %d):"), CVarExplicitTickOrder.GetValueOnGameThread() ? 1 : 0);
+
+	for (int32 i = 0; i < ticks.Num(); i++) {
+		FTickFunction* tick = ticks[i].Value;
+		const ETickingGroup group = tick->GetActualTickGroup();
+
+		if (!bLoggedCameraUpdate && group >= TG_PostUpdateWork) {
+			UE_LOG(LogTemp, Display, TEXT("   -  Camera Manager Update (after TG_PostPhysics)"));
+			bLoggedCameraUpdate = true;
+		}
+
+		FString prerequisites;
+		for (FTickPrerequisite& prerequisite : tick->GetPrerequisites()) {
+			if (FTickFunction* prerequisiteTick = prerequisite.Get())
+				prerequisites += (prerequisites.IsEmpty() ? TEXT("") : TEXT(", ")) + prerequisiteTick->DiagnosticMessage();
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("  %2d. %-30s %-20s enabled %d  after: %s"), i + 1, *ticks[i].Key,
+			*tickGroupEnum->GetNameStringByValue(group), tick->IsTickFunctionEnabled() ? 1 : 0,
+			prerequisites.IsEmpty() ? TEXT("-") : *prerequisites);
+	}
+
+	if (!bLoggedCameraUpdate)
+		UE_LOG(LogTemp, Display, TEXT("   -  Camera Manager Update (after TG_PostPhysics)"));
 }
 
 
@@ -56,8 +187,13 @@ void ULockOnTargeting::BeginPlay()
 void ULockOnTargeting::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	LOCKON_SCOPED_TIMER(STAT_LockOnTargetingTick, LockOnTargeting, TargetingTick);
 
 
+	// *** Keep Ranked Targets Current (lock on input and retargeting read them)
+	if (CVarUseTargetRanking.GetValueOnGameThread())
+		UpdateTargetRanking(DeltaTime);
+
 	// *** Update Lock on Targeting
 	if (bIsTargeting)
 		UpdateTargeting();
@@ -80,8 +216,20 @@ void ULockOnTargeting::TickComponent(float DeltaTime, ELevelTick TickType, FActo
 		}
 	}
 
+	// *** Call UpdateNonTargeting When Something Changed
+	if (!bIsTargeting && bUseEventDrivenNonTargeting) {
+
+		if (ShouldUpdateNonTargeting()) {
+			UpdateNonTargeting();
+			INC_DWORD_STAT(STAT_LockOnNonTargetingTriggered);
+		}
+		else {
+			INC_DWORD_STAT(STAT_LockOnNonTargetingSkipped);
+		}
+	}
+
 	// *** Call UpdateNonTargeting on Interval
-	if (!bIsTargeting) {
+	else if (!bIsTargeting) {
 		UpdateNonTargetingTimer -= DeltaTime;
 
 		if (UpdateNonTargetingTimer <= 0) {
@@ -89,6 +237,10 @@ void ULockOnTargeting::TickComponent(float DeltaTime, ELevelTick TickType, FActo
 			UpdateNonTargetingTimer = UpdateNonTargetingInterval;
 		}
 	}
+
+	// *** Trace Line of Sight to Targets in Range (results are used next frame)
+	if (bRequireLineOfSight)
+		VisibilityCache.Update(GetWorld(), GetVisibilityViewLocation(), PlayerActor, &VisibilityTraceDelegate);
 }
 
 
@@ -96,7 +248,7 @@ void ULockOnTargeting::TickComponent(float DeltaTime, ELevelTick TickType, FActo
 void ULockOnTargeting::OnTargetingInputStart() {
 
 	// *** Get Nearest Actor With Targetable Tag
-	TargetedActor = GetNearestTarget(true);
+	TargetedActor = CVarUseTargetRanking.GetValueOnGameThread() ? GetRankedNearestTarget(true) : GetNearestTarget(true);
 
 	// *** Start Lock On Targeting
 	if (TargetedActor) {			// If there is a target to lock onto
@@ -126,7 +278,22 @@ void ULockOnTargeting::OnTargetingInputStart() {
 // Sets target to the next closest target to the left or right of current one
 void ULockOnTargeting::OnSwitchDirectionalTargetInput(bool bGetRight) {
 
-	TargetedActor = GetNextTargetInDirection(bGetRight);
+	MarkRecentlyTargeted(TargetedActor);
+
+	// *** Neighbor by Yaw, Repeated Switches Walk the Ring Without Querying
+	if (CVarUseTargetRanking.GetValueOnGameThread() && CVarUseAngularTargetRing.GetValueOnGameThread()) {
+
+		if (AActor* neighbor = TargetRing.FindNeighbor(TargetedActor, bGetRight, bWrapDirectionalSwitch))
+			TargetedActor = neighbor;
+	}
+
+	// *** Nearest Lateral Offset
+	else {
+		AActor* rankedTarget = CVarUseTargetRanking.GetValueOnGameThread() ? GetRankedTargetInDirection(bGetRight) : nullptr;
+		TargetedActor = rankedTarget ? rankedTarget : GetNextTargetInDirection(bGetRight);
+		RankingRefreshTimer = 0.0f;		// Left and right are relative to the new target now
+	}
+
 	TargetingArrow->SetTarget(TargetedActor);
 	TargetingArrow->StartTargetingMode();
 }
@@ -136,10 +303,27 @@ void ULockOnTargeting::OnSwitchDirectionalTargetInput(bool bGetRight) {
 void ULockOnTargeting::UpdateTargeting() {
 	
 	// *** Check to Stop Targeting
-	if (!IsValid(TargetedActor) || SpringArm->TargetArmLength > MaxTargetingDistance) {
+	if (SpringArm->TargetArmLength > MaxTargetingDistance) {
 		OnTargetingInputEnd();
 		return;
 	}
+
+	// *** Switch to the Next Ranked Target When the Target Dies or Despawns (pooled enemies are hidden instead of destroyed)
+	if (!IsTargetable(TargetedActor)) {
+
+		AActor* replacement = bRetargetOnTargetLost ? GetReplacementTarget(TargetedActor) : nullptr;
+		if (!replacement) {
+			OnTargetingInputEnd();
+			return;
+		}
+
+		MarkRecentlyTargeted(TargetedActor);
+		TargetedActor = replacement;
+		TargetingArrow->SetTarget(TargetedActor);
+		TargetingArrow->StartTargetingMode();
+		RankingRefreshTimer = 0.0f;
+		INC_DWORD_STAT(STAT_LockOnRetargets);
+	}
 	
 	// *** Update Spring Arm Target Offset
 	FVector targetOffset = (TargetedActor->GetActorLocation() - PlayerActor->GetActorLocation()) / 2;
@@ -167,6 +351,9 @@ void ULockOnTargeting::UpdateTargeting() {
 		TargetRotation, GetWorld()->GetDeltaSeconds(), CameraRotationSpeed);
 
 	PlayerController->SetControlRotation(interpolatedRot);
+
+	if (InputLatency)
+		InputLatency->MarkConsumed(ELockOnLatencyConsumer::TargetingCamera);
 }
 
 
@@ -197,9 +384,30 @@ void ULockOnTargeting::UpdateTargetingCleanup() {
 	SpringArm->TargetArmLength = interpolatedLength;
 }
 
+// Checks if the player moved, the camera turned, or a target in range entered, left or moved
+bool ULockOnTargeting::ShouldUpdateNonTargeting() {
+
+	FVector playerLocation = PlayerActor->GetActorLocation();
+	float cameraYaw = Camera->GetComponentRotation().Yaw;
+	uint32 regionVersion = TargetableRegistry->GetRegionVersion(GetTargetingSphereCenter(), MaxTargetingDistance / 2.0f);
+
+	return FVector::DistSquared(playerLocation, LastNonTargetingPlayerLocation) >
+			NonTargetingPlayerMoveThreshold * NonTargetingPlayerMoveThreshold
+		|| FMath::Abs(FRotator::NormalizeAxis(cameraYaw - LastNonTargetingCameraYaw)) > NonTargetingCameraYawThreshold
+		|| regionVersion != LastNonTargetingRegionVersion
+		|| VisibilityCache.GetVersion() != LastNonTargetingVisibilityVersion;
+}
+
+
 // Sets arrow sprite over the head of the nearest enemy in range
 void ULockOnTargeting::UpdateNonTargeting() {
 
+	// *** Store State Used to Detect the Next Change
+	LastNonTargetingPlayerLocation = PlayerActor->GetActorLocation();
+	LastNonTargetingCameraYaw = Camera->GetComponentRotation().Yaw;
+	LastNonTargetingRegionVersion = TargetableRegistry->GetRegionVersion(GetTargetingSphereCenter(), MaxTargetingDistance / 2.0f);
+	LastNonTargetingVisibilityVersion = VisibilityCache.GetVersion();
+
 	AActor* nearestTarget = GetNearestTarget(false);
 
 	if (!nearestTarget) {							// If no targets in range, hide arrow
@@ -229,6 +437,8 @@ void ULockOnTargeting::OnTargetingInputEnd() {
 	else
 		PreviousTargetedActor = nullptr;
 
+	MarkRecentlyTargeted(PreviousTargetedActor);
+
 	TargetedActor = nullptr;
 
 	TargetingOffsetRotation = FRotator::ZeroRotator;
@@ -239,119 +449,372 @@ void ULockOnTargeting::OnTargetingInputEnd() {
 }
 
 
-// Returns all actors with targetable tag in range of the sphere overlap
-TArray<AActor*> ULockOnTargeting::GetAllTargetsInRange() {
-	TArray<AActor*> nearbyActors;
+// Fills TargetCandidates with all registered actors with targetable tag in range of the targeting sphere
+void ULockOnTargeting::GatherTargetsInRange() {
+
+	TargetCandidates.Reset();
+
+	// *** Find All Registered Actors in Sphere With Targetable Tag
+	TargetableRegistry->QueryTargetsInSphere(GetTargetingSphereCenter(), MaxTargetingDistance / 2.0f,
+		TargetableTagMask, ActorsToIgnore, TargetCandidates);
+
+	if (!bRequireLineOfSight) return;
+
+	// *** Remove Targets Behind Geometry (cached results, never traces here)
+	//	Targets still waiting for their first trace are left out too, they become selectable once it comes back
+	VisibilityCache.SetWatchedTargets(TargetCandidates.Actors);
+
+	for (int32 i = TargetCandidates.Num() - 1; i >= 0; i--) {
+		if (!VisibilityCache.HasVisibleResult(TargetCandidates.Actors[i])) {
+			TargetCandidates.RemoveAtSwap(i);
+			INC_DWORD_STAT(STAT_LockOnTargetsOccluded);
+		}
+	}
+}
+
+
+// Line of sight is traced from the player's eyes rather than the camera, which swings around on the spring arm
+FVector ULockOnTargeting::GetVisibilityViewLocation() const {
+
+	FVector eyeLocation;
+	FRotator eyeRotation;
+	PlayerActor->GetActorEyesViewPoint(eyeLocation, eyeRotation);
+	return eyeLocation;
+}
+
+
+void ULockOnTargeting::OnVisibilityTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum) {
+	VisibilityCache.HandleTraceResult(Datum);
+}
+
+
+// Returns the center of the targeting sphere, which sits in front of the camera
+FVector ULockOnTargeting::GetTargetingSphereCenter() const {
 
-	// *** Get All Actors in Sphere Overlap
 	float sphereRadius = MaxTargetingDistance / 2.0f;
 	FVector camForward2D = Camera->GetForwardVector().GetSafeNormal2D();
 
-	FVector sphereStart = PlayerActor->GetActorLocation() + (camForward2D * sphereRadius);
+	return PlayerActor->GetActorLocation() + (camForward2D * sphereRadius);
+}
+
 
-	UKismetSystemLibrary::SphereOverlapActors(GetWorld(), sphereStart,
-		sphereRadius, ObjectTypes, nullptr, ActorsToIgnore, nearbyActors);
+// Gathers targets and runs the selection kernel, reusing the result for the rest of the frame
+const FTargetSelectionResult& ULockOnTargeting::GetTargetSelection() {
 
+	// *** Reuse Result if Already Selected This Frame
+	if (TargetSelectionFrame == GFrameCounter && TargetSelectionExcludedActor == TargetedActor)
+		return TargetSelection;
 
-	TArray<AActor*> targetableActors;
+	TargetSelectionFrame = GFrameCounter;
+	TargetSelectionExcludedActor = TargetedActor;
 
-	// *** Find All Actors in Overlap With Targetable Tag
-	for (AActor* actor : nearbyActors) {
+	LOCKON_SCOPED_TIMER(STAT_LockOnTargetSelection, LockOnTargeting, TargetSelection);
+	LLM_SCOPE_BYTAG(LockOnTargeting);
+	INC_DWORD_STAT(STAT_LockOnTargetQueries);
+	const SIZE_T scratchSizeBefore = TargetCandidates.GetAllocatedSize();
+
+	// *** Score Every Candidate in One Pass
+	GatherTargetsInRange();
+	int32 targetedIndex = TargetedActor ? TargetCandidates.Actors.IndexOfByKey(TargetedActor) : INDEX_NONE;
+	INC_DWORD_STAT_BY(STAT_LockOnCandidatesScanned, TargetCandidates.Num());
+	CSV_CUSTOM_STAT(LockOnTargeting, CandidatesScanned, TargetCandidates.Num(), ECsvCustomStatOp::Accumulate);
+
+	TargetSelection::SelectTargets(TargetCandidates, PlayerActor->GetActorLocation(), PlayerActor->GetActorRightVector(),
+		MaxTargetingDistance * MaxTargetingDistance, targetedIndex, TargetSelection, RankedTargetCount);
+
+	if (SelectionPolicy != ETargetSelectionPolicy::Nearest)
+		RankWithSelectionPolicy();
+
+	// *** Track Scratch Growth (should stay at zero once the buffers are warm)
+	const SIZE_T scratchSizeAfter = TargetCandidates.GetAllocatedSize();
+	if (scratchSizeAfter != scratchSizeBefore)
+		INC_DWORD_STAT(STAT_LockOnTargetQueryAllocations);
+	SET_MEMORY_STAT(STAT_LockOnTargetQueryScratchMemory, scratchSizeAfter);
+
+	return TargetSelection;
+}
 
-		// *** Check if Implementing Gameplay Tags Interface
-		IGameplayTagAssetInterface* tagInterface = Cast<IGameplayTagAssetInterface>(actor);
-		if (!tagInterface) continue;
 
-		// *** Check if Actor has Targetable Tag
-		if (tagInterface->HasMatchingGameplayTag(TargetableTag))
-			targetableActors.Add(actor);
+// Copies this frame's targets in range into the caller's buffer, skipping excluded actors
+void ULockOnTargeting::QueryTargetsInRange(FTargetActorArray& OutTargets, TFunctionRef<bool(const AActor*)> ExcludePredicate) {
+
+	GetTargetSelection();		// Gathers candidates if not already gathered this frame
+	OutTargets.Reset();
+
+	for (AActor* actor : TargetCandidates.Actors) {
+		if (IsValid(actor) && !ExcludePredicate(actor))
+			OutTargets.Add(actor);
 	}
+}
+
+
+// Returns the candidate actor at index if it is still valid
+AActor* ULockOnTargeting::GetCandidateActor(int32 Index) const {
+
+	if (!TargetCandidates.Actors.IsValidIndex(Index)) return nullptr;
 
-	return targetableActors;
+	AActor* actor = TargetCandidates.Actors[Index];
+	return IsValid(actor) ? actor : nullptr;
 }
 
 
-// Returns the closest actor with targetable gameplay tag in sphere overlap. 
+// Returns the closest actor with targetable gameplay tag in targeting sphere. 
 //	If switching targets by distance instead of direction, then it gets the next closest actor.
 AActor* ULockOnTargeting::GetNearestTarget(bool bConsiderPreviousTarget) {
 
-	// *** Get All Actors With Targetable Tag in Sphere Overlap
-	TArray<AActor*> targetableActors = GetAllTargetsInRange();
-	bool bRemovedPreviousTarget = false;
+	const FTargetSelectionResult& selection = GetTargetSelection();
+	AActor* closestActor = GetCandidateActor(selection.NearestIndex);
 
 	// *** Check if Switching Targets
 	if (bConsiderPreviousTarget && bCanSwitchTargets &&
-		PreviousTargetedActor && targetableActors.Contains(PreviousTargetedActor)) 
+		PreviousTargetedActor && closestActor == PreviousTargetedActor)
 	{
-		targetableActors.Remove(PreviousTargetedActor);
-		bRemovedPreviousTarget = true;
+		AActor* secondClosestActor = GetCandidateActor(selection.SecondNearestIndex);
+
+		if (secondClosestActor)		// If there is another targetable actor besides previous target
+			return secondClosestActor;
+		else						// If previous target is the only nearby targetable actor
+			return PreviousTargetedActor;
 	}
 
-	// *** Initialize Variables
-	AActor* closestActor = nullptr;
-	float closestDistSqr = MaxTargetingDistance * MaxTargetingDistance;
-	float curDistSqr = FLT_MAX;
+	return closestActor;
+}
+
 
-	// *** Find Closest Target
-	for(AActor* actor : targetableActors) {
+// Returns the next closest target to the left or right of the current target
+AActor* ULockOnTargeting::GetNextTargetInDirection(bool bCheckRight) {
+
+	const FTargetSelectionResult& selection = GetTargetSelection();
+	AActor* closestActor = GetCandidateActor(bCheckRight ? selection.RightIndex : selection.LeftIndex);
+
+	// *** Return Next Target
+	if (!closestActor)
+		return TargetedActor;
+	else
+		return closestActor;
+}
+
+
+// Rebuilds the ranking from a full query on an interval, in between only the few ranked targets are reordered
+void ULockOnTargeting::UpdateTargetRanking(float DeltaTime) {
+
+	RankingRefreshTimer -= DeltaTime;
+
+	if (RankingRefreshTimer <= 0.0f) {
+		RefreshTargetRanking();
+		RankingRefreshTimer = RankingRefreshInterval;
+	}
+	else {
+		ReorderTargetRanking();
+	}
+}
+
+
+void ULockOnTargeting::RefreshTargetRanking() {
+
+	const FTargetSelectionResult& selection = GetTargetSelection();
+	INC_DWORD_STAT(STAT_LockOnTargetRankingRefreshes);
+
+	RankedTargets.Reset();
+	for (int32 index : selection.RankedIndices) {
+		if (AActor* actor = GetCandidateActor(index))
+			RankedTargets.Add(actor);
+	}
+
+	RankedLeftTarget = GetCandidateActor(selection.LeftIndex);
+	RankedRightTarget = GetCandidateActor(selection.RightIndex);
+	RankedDirectionalExcludedActor = TargetedActor;
+
+	if (CVarUseAngularTargetRing.GetValueOnGameThread())
+		TargetRing.Rebuild(TargetCandidates, PlayerActor->GetActorLocation(), Camera->GetComponentRotation().Yaw);
+}
+
+
+// Removes targets that died, despawned, went out of range or out of sight, then sorts by distance to the player
+void ULockOnTargeting::ReorderTargetRanking() {
+
+	const FVector playerLocation = PlayerActor->GetActorLocation();
+	const float maxDistanceSqr = MaxTargetingDistance * MaxTargetingDistance;
+
+	for (int32 i = RankedTargets.Num() - 1; i >= 0; i--) {
+
+		AActor* actor = RankedTargets[i].Get();
+		if (!IsTargetable(actor) || FVector::DistSquared(actor->GetActorLocation(), playerLocation) >= maxDistanceSqr
+			|| (bRequireLineOfSight && !VisibilityCache.IsVisible(actor)))
+		{
+			RankedTargets.RemoveAt(i, EAllowShrinking::No);
+		}
+	}
+
+	// Other policies keep the order of the last refresh, their scores aren't cheap to redo for a few actors
+	if (SelectionPolicy == ETargetSelectionPolicy::Nearest) {
+		RankedTargets.StableSort([&playerLocation](const TWeakObjectPtr<AActor>& a, const TWeakObjectPtr<AActor>& b) {
+			return FVector::DistSquared(a->GetActorLocation(), playerLocation) < FVector::DistSquared(b->GetActorLocation(), playerLocation);
+		});
+	}
+
+	// *** Keep the Ring Sorted as Targets and the Camera Move
+	if (CVarUseAngularTargetRing.GetValueOnGameThread()) {
+		TargetRing.UpdateYaws(playerLocation, Camera->GetComponentRotation().Yaw, [this, &playerLocation, maxDistanceSqr](AActor* actor) {
+			return IsTargetable(actor) && FVector::DistSquared(actor->GetActorLocation(), playerLocation) < maxDistanceSqr
+				&& (!bRequireLineOfSight || VisibilityCache.IsVisible(actor));
+		});
+	}
+}
+
+
+// Same choice as GetNearestTarget, read from the ranking
+AActor* ULockOnTargeting::GetRankedNearestTarget(bool bConsiderPreviousTarget) {
 
-		curDistSqr = actor->GetSquaredDistanceTo(PlayerActor);
+	AActor* closestActor = nullptr;
+	AActor* secondClosestActor = nullptr;
+
+	for (const TWeakObjectPtr<AActor>& rankedTarget : RankedTargets) {
+		AActor* actor = rankedTarget.Get();
+		if (!IsTargetable(actor)) continue;
 
-		if (curDistSqr < closestDistSqr) {	// Found new closest actor
-			closestDistSqr = curDistSqr;
+		if (!closestActor)
 			closestActor = actor;
+		else {
+			secondClosestActor = actor;
+			break;
 		}
 	}
 
-	// *** Return Next Target
-	if (!closestActor && bRemovedPreviousTarget)	// If previous target is the only nearby targetable actor	
-		return PreviousTargetedActor;
-	else											// If there is another targetable actor besides previous target
-		return closestActor;
+	// *** Check if Switching Targets
+	if (bConsiderPreviousTarget && bCanSwitchTargets &&
+		PreviousTargetedActor && closestActor == PreviousTargetedActor)
+	{
+		return secondClosestActor ? secondClosestActor : PreviousTargetedActor;
+	}
+
+	return closestActor;
 }
 
 
-// Returns the next closest target to the left or right of the current target
-AActor* ULockOnTargeting::GetNextTargetInDirection(bool bCheckRight) {
+// Returns the ranked left or right target if it was picked relative to the current target, null to fall back to a query
+AActor* ULockOnTargeting::GetRankedTargetInDirection(bool bCheckRight) {
+
+	if (RankedDirectionalExcludedActor.Get() != TargetedActor) return nullptr;
 
-	// *** Get All Actors With Targetable Tag in Sphere Overlap
-	TArray<AActor*> targetableActors = GetAllTargetsInRange();
+	AActor* actor = bCheckRight ? RankedRightTarget.Get() : RankedLeftTarget.Get();
+	return IsTargetable(actor) ? actor : nullptr;
+}
 
-	// *** Ignore Current Actor
-	if (TargetedActor && targetableActors.Contains(TargetedActor))
-		targetableActors.Remove(TargetedActor);
 
-	// *** Initialize Variables
-	AActor* closestActor = nullptr;
-	float curDotProd;
-	float closestDotProd = bCheckRight ? FLT_MAX : -FLT_MAX; // Set to max if checking for target on right, otherwise set to min
+// Picks the nearest ranked target other than the lost one, queries when ranking is off
+AActor* ULockOnTargeting::GetReplacementTarget(const AActor* LostTarget) {
 
+	if (!CVarUseTargetRanking.GetValueOnGameThread()) {
+		AActor* nearestTarget = GetNearestTarget(false);
+		return nearestTarget != LostTarget && IsTargetable(nearestTarget) ? nearestTarget : nullptr;
+	}
 
-	// *** Find Closest Target
-	for (AActor* actor : targetableActors) {
+	for (const TWeakObjectPtr<AActor>& rankedTarget : RankedTargets) {
+		AActor* actor = rankedTarget.Get();
+		if (actor != LostTarget && IsTargetable(actor))
+			return actor;
+	}
 
-		// *** Get Dot Product Between Player Right and Target Direction
-		curDotProd = FVector::DotProduct
-			(PlayerActor->GetActorRightVector(), actor->GetActorLocation() - PlayerActor->GetActorLocation());
-		
-		// *** Check if Target is Next Closest to the Right
-		if (bCheckRight && curDotProd > 0 && curDotProd < closestDotProd) {
-			closestActor = actor;
-			closestDotProd = curDotProd;
+	return nullptr;
+}
+
+
+// Picks the precompiled scorer once per query, the scoring loop itself has no per candidate dispatch
+void ULockOnTargeting::RankWithSelectionPolicy() {
+
+	FTargetScoringContext context;
+	context.ViewLocation = Camera->GetComponentLocation();
+	context.ViewForward = Camera->GetForwardVector();
+	context.MaxDistanceSqr = MaxTargetingDistance * MaxTargetingDistance;
+	context.InvMaxDistanceSqr = 1.0f / FMath::Max(context.MaxDistanceSqr, 1.0f);
+	context.DistanceWeight = DistanceWeight;
+	context.ScreenCenterWeight = ScreenCenterWeight;
+	context.ThreatWeight = ThreatWeight;
+	context.RecencyWeight = RecencyWeight;
+
+	switch (SelectionPolicy) {
+		case ETargetSelectionPolicy::ScreenCenter:
+			RankWithScorer<TargetScoring::FScreenCenterScorer>(context);
+			break;
+
+		case ETargetSelectionPolicy::Threat:
+			RankWithScorer<TargetScoring::FThreatScorer>(context);
+			break;
+
+		case ETargetSelectionPolicy::Crowd:
+			RankWithScorer<TargetScoring::FCrowdScorer>(context);
+			break;
+
+		default:
+			break;
+	}
+}
+
+
+template<typename TScorer>
+void ULockOnTargeting::RankWithScorer(const FTargetScoringContext& Context) {
+
+	// *** Fill Recency Only for Scorers That Read It
+	if constexpr (TScorer::bNeedsRecency) {
+
+		const double now = GetWorld()->GetTimeSeconds();
+		const float invWindow = 1.0f / FMath::Max(RecencyWindow, UE_KINDA_SMALL_NUMBER);
+		TargetCandidates.Recencies.SetNumUninitialized(TargetCandidates.Num(), EAllowShrinking::No);
+
+		for (int32 i = 0; i < TargetCandidates.Num(); i++) {
+			const double* targetedTime = LastTargetedTimes.Find(TargetCandidates.Actors[i]);
+			TargetCandidates.Recencies[i] = targetedTime ? FMath::Clamp(1.0f - (float)(now - *targetedTime) * invWindow, 0.0f, 1.0f) : 0.0f;
 		}
+	}
 
-		// *** Check if Target is Next Closest to the Left
-		else if (!bCheckRight && curDotProd < 0 && curDotProd > closestDotProd) {
-			closestActor = actor;
-			closestDotProd = curDotProd;
+	// *** Fill Screen Offsets Only for Scorers That Read Them
+	if constexpr (TScorer::bNeedsScreenOffsets) {
+
+		const bool bHasView = ScreenProjection && ScreenProjection->HasView();
+		TargetCandidates.ScreenOffsetsSqr.SetNumUninitialized(TargetCandidates.Num(), EAllowShrinking::No);
+
+		for (int32 i = 0; i < TargetCandidates.Num(); i++) {
+
+			FVector2f screenPosition;
+			if (bHasView) {
+				// Behind the camera is as far from the center as it gets
+				TargetCandidates.ScreenOffsetsSqr[i] = ScreenProjection->GetScreenPosition(TargetCandidates.Actors[i], screenPosition) ?
+					FMath::Min(screenPosition.SizeSquared(), 4.0f) : 4.0f;
+				continue;
+			}
+
+			// No projected view yet (or LockOn.UseScreenProjectionCache is off), 1 - cosine to the camera forward also ranges 0 to 2
+			const FVector direction = FVector(TargetCandidates.LocationsX[i], TargetCandidates.LocationsY[i], TargetCandidates.LocationsZ[i]) - Context.ViewLocation;
+			const float offset = 1.0f - (float)FVector::DotProduct(direction.GetSafeNormal(), Context.ViewForward);
+			TargetCandidates.ScreenOffsetsSqr[i] = offset * offset;
 		}
 	}
 
-	// *** Return Next Target
-	if (!closestActor)
-		return TargetedActor;
-	else
-		return closestActor;
+	TargetScoring::RankCandidates<TScorer>(TargetCandidates, Context, RankedTargetCount, TargetSelection);
+}
+
+
+void ULockOnTargeting::MarkRecentlyTargeted(AActor* Actor) {
+
+	if (!Actor) return;
+
+	const double now = GetWorld()->GetTimeSeconds();
+	LastTargetedTimes.Add(Actor, now);
+
+	// *** Forget Targets Outside the Window Once a Few Have Piled Up
+	if (LastTargetedTimes.Num() > 32) {
+		for (auto it = LastTargetedTimes.CreateIterator(); it; ++it) {
+			if (now - it.Value() > RecencyWindow)
+				it.RemoveCurrent();
+		}
+	}
+}
+
+
+// Dying enemies unregister from the registry right away, despawned ones are also hidden
+bool ULockOnTargeting::IsTargetable(AActor* Actor) const {
+	return IsValid(Actor) && !Actor->IsHidden() && TargetableRegistry->IsRegistered(Actor);
 }
 
 
@@ -371,6 +834,9 @@ void ULockOnTargeting::UpdateCameraReset(float DeltaTime) {
 
 	// *** Apply Rotation
 	PlayerController->SetControlRotation(interpolatedRot);
+
+	if (InputLatency)
+		InputLatency->MarkConsumed(ELockOnLatencyConsumer::TargetingCamera);
 }
 
 
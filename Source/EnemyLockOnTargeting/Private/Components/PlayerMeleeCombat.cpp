@@ -11,6 +11,7 @@
 #include "GameFramework/CharacterMovementComponent.h"	// Character Movement (is falling)
 #include "Animation/PlayerAnimInstance.h"				// Player Anim Instance
 #include "Characters/EnemyCharacter.h"					// Enemy Character
+#include "LockOnTargetingStats.h"						// Montage play stat
 
 // Sets default values for this component's properties
 UPlayerMeleeCombat::UPlayerMeleeCombat()
@@ -52,6 +53,7 @@ void UPlayerMeleeCombat::OnAttackInput() {
 
 	// *** Play Normal Attack Montage
 	PlayerAnimInstance->Montage_Play(AttackMontage);
+	LOCKON_COUNT_MONTAGE_PLAY();
 	bIsAttacking = true;
 	PlayerCharacter->StopMoveInput();
 }
@@ -126,12 +128,14 @@ void UPlayerMeleeCombat::OnTakeDamage(AActor* DamagedActor, float Damage, const
 	// *** Block Attack
 	if (dotProd < 0) {	// If attacker is facing player
 		PlayerAnimInstance->Montage_Play(BlockMontage);
+		LOCKON_COUNT_MONTAGE_PLAY();
 		bCanAttack = false;
 		PlayerCharacter->StopMoveInput();
 	}
 	// *** Hurt Player
 	else {				// If not shielding or attacker is facing same direction as player (behind)
 		PlayerAnimInstance->Montage_Play(HurtMontage);
+		LOCKON_COUNT_MONTAGE_PLAY();
 		bCanAttack = false;
 		PlayerCharacter->StopMoveInput();
 	}
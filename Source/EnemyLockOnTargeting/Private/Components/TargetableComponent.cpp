@@ -0,0 +1,85 @@
+/*
+* Author: Eyan Martucci
+* Description: Registers its owner with the targetable registry so lock on targeting can find it.
+*	Enemies register themselves, any other actor that should be targetable needs this component.
+*/
+
+#include "Components/TargetableComponent.h"
+
+#include "GameplayTagAssetInterface.h"			// For IGameplayTagAssetInterface
+#include "Subsystems/TargetableRegistry.h"		// For registering the owner
+#include "Characters/EnemyCharacter.h"			// For skipping self registering enemies
+
+
+// Sets default values for this component's properties
+UTargetableComponent::UTargetableComponent()
+{
+	// Locations are pushed to the registry when the owner moves, nothing to do every frame
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+
+// Called when the game starts
+void UTargetableComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Enemies register themselves, including when they leave and rejoin the pool
+	AActor* owner = GetOwner();
+	if (owner->IsA<AEnemyCharacter>())
+		return;
+
+	TargetableRegistry = GetWorld()->GetSubsystem<UTargetableRegistry>();
+	if (!TargetableRegistry)
+		return;
+
+	// *** Register the owner and follow its root component
+	TargetableRegistry->RegisterTarget(owner, GetRegisteredTags());
+
+	if (USceneComponent* root = owner->GetRootComponent())
+		root->TransformUpdated.AddUObject(this, &UTargetableComponent::OnRootTransformUpdated);
+}
+
+
+// Called when the game ends or the owner is destroyed
+void UTargetableComponent::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+
+	if (TargetableRegistry) {
+
+		TargetableRegistry->UnregisterTarget(GetOwner());
+
+		if (USceneComponent* root = GetOwner()->GetRootComponent())
+			root->TransformUpdated.RemoveAll(this);
+
+		TargetableRegistry = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+void UTargetableComponent::SetTargetableTags(const FGameplayTagContainer& NewTags) {
+
+	TargetableTags = NewTags;
+
+	if (TargetableRegistry)
+		TargetableRegistry->UpdateTargetTags(GetOwner(), GetRegisteredTags());
+}
+
+
+FGameplayTagContainer UTargetableComponent::GetRegisteredTags() const {
+
+	FGameplayTagContainer tags = TargetableTags;
+
+	if (const IGameplayTagAssetInterface* tagInterface = Cast<IGameplayTagAssetInterface>(GetOwner()))
+		tagInterface->GetOwnedGameplayTags(tags);		// Appends
+
+	return tags;
+}
+
+
+void UTargetableComponent::OnRootTransformUpdated(USceneComponent* UpdatedComponent,
+	EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	TargetableRegistry->UpdateTargetLocation(GetOwner(), UpdatedComponent->GetComponentLocation());
+}
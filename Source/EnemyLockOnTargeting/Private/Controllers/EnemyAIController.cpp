@@ -11,6 +11,16 @@
 #include "Perception/AIPerceptionSystem.h"		// Perception System
 #include "Characters/PlayerCharacter.h"			// Player Character
 #include "Navigation/PathFollowingComponent.h"	// FPathFollowingResult
+#include "LockOnTargetingStats.h"				// Stats and CSV timers
+#include "TimerManager.h"						// State timers
+#include "Subsystems/EnemyStateTimerSubsystem.h"	// Shared state timer wheel
+#include "Subsystems/RoamPointSubsystem.h"		// Cached roam destinations
+#include "Subsystems/PathRequestSubsystem.h"	// Budgeted async path requests
+#include "Subsystems/ChaseFlowFieldSubsystem.h"	// Shared chase flow field
+#include "Subsystems/EnemyPerceptionSubsystem.h"	// Shared sight perception
+#include "Perception/AISense_Sight.h"			// Sight Sense
+#include "Subsystems/EnemyDecisionSubsystem.h"	// Packed decision state
+#include "Subsystems/DeterministicSimSubsystem.h"	// Seeded random stream
 
 AEnemyAIController::AEnemyAIController() {
 
@@ -41,32 +51,113 @@ void AEnemyAIController::OnPossess(APawn* InPawn) {
 	SetPawn(InPawn);
 	NavSystem = Cast<UNavigationSystemV1>(GetWorld()->GetNavigationSystem());
 	EnemyCharacter = Cast<AEnemyCharacter>(InPawn);
+	StateTimerSubsystem = GetWorld()->GetSubsystem<UEnemyStateTimerSubsystem>();
+	RoamPointSubsystem = GetWorld()->GetSubsystem<URoamPointSubsystem>();
+	PathRequestSubsystem = GetWorld()->GetSubsystem<UPathRequestSubsystem>();
+	ChaseFlowField = GetWorld()->GetSubsystem<UChaseFlowFieldSubsystem>();
+
+	if (UDeterministicSimSubsystem* deterministicSim = GetWorld()->GetSubsystem<UDeterministicSimSubsystem>())
+		RandomStream = deterministicSim->CreateRandomStream();
+
+	ActivateAI();
+}
+
+
+// Runs on possession and again whenever the pawn is taken out of the enemy pool
+void AEnemyAIController::ActivateAI() {
+
+	if (RoamPointSubsystem) {
+		RoamPointSubsystem->SetRoamRadius(RoamRadius);
+		RoamPointSubsystem->PrewarmRegion(GetPawn()->GetActorLocation());
+	}
+
+	// *** Use Shared Perception Instead of the Sight Sense (kept running when validating against it)
+	bool bUseSightSense = true;
+
+	if (UEnemyPerceptionSubsystem::IsEnabled()) {
+		PerceptionSubsystem = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>();
+
+		FEnemySightConfig sightConfig;
+		sightConfig.SightRadius = SightRadius;
+		sightConfig.LoseSightRadius = LoseSightRadius;
+		sightConfig.PeripheralVisionAngleDegrees = SightConfigComp->PeripheralVisionAngleDegrees;
+		sightConfig.TimeUntilLosingSight = TimeUntilLosingSight;
+		PerceptionSubsystem->RegisterListener(this, sightConfig);
+
+		bUseSightSense = UEnemyPerceptionSubsystem::IsValidating();
+	}
+
+	AIPerceptionComp->SetSenseEnabled(UAISense_Sight::StaticClass(), bUseSightSense);
+
+	// *** Move Per Frame Decisions Into the Packed Decision Array
+	if (UEnemyDecisionSubsystem::IsEnabled()) {
+		DecisionSubsystem = GetWorld()->GetSubsystem<UEnemyDecisionSubsystem>();
+		DecisionId = DecisionSubsystem->RegisterEnemy(this, RetreatDistance);
+	}
 
 	SwitchEnemyState(EEnemyState::RoamIdle);	// Starting state
 }
 
 
-void AEnemyAIController::Tick(float DeltaTime) {
-	Super::Tick(DeltaTime);
+// Clears every pending timer, move and perception so a dead or pooled pawn does nothing
+void AEnemyAIController::DeactivateAI() {
 
-	// *** Handle Timer Based States
-	if (CurState == EEnemyState::RoamIdle) {
-		Timer -= DeltaTime;
-		if (Timer <= 0)
-			SwitchEnemyState(EEnemyState::Roaming);
+	ClearStateTimer();
+	if (PathRequestSubsystem)
+		PathRequestSubsystem->CancelRequests(this);
+	if (ChaseFlowField)
+		ChaseFlowField->RemoveChaser(this);
+
+	if (PerceptionSubsystem) {
+		PerceptionSubsystem->UnregisterListener(this);
+		PerceptionSubsystem = nullptr;
 	}
-	else if (CurState == EEnemyState::ChaseIdle) {
-		Timer -= DeltaTime;
-		if (Timer <= 0)
-			SwitchEnemyState(EEnemyState::Chasing);
+
+	if (DecisionSubsystem) {
+		DecisionSubsystem->UnregisterEnemy(DecisionId);
+		DecisionSubsystem = nullptr;
 	}
-	else if (CurState == EEnemyState::Retreating) {
+
+	// Forget the player so sight is gained again after reuse
+	AIPerceptionComp->SetSenseEnabled(UAISense_Sight::StaticClass(), false);
+	AIPerceptionComp->ForgetAll();
+
+	StopMovement();
+	ClearFocus(EAIFocusPriority::Gameplay);
+	TargetActor = nullptr;
+	CurState = EEnemyState::RoamIdle;
+	SetActorTickEnabled(false);
+}
+
+
+void AEnemyAIController::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+
+	if (PerceptionSubsystem)
+		PerceptionSubsystem->UnregisterListener(this);
+
+	if (DecisionSubsystem)
+		DecisionSubsystem->UnregisterEnemy(DecisionId);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+void AEnemyAIController::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+	LOCKON_SCOPED_TIMER(STAT_LockOnEnemyAITick, EnemyAI, EnemyAITick);
+
+	// *** Count Down the State Timer (only in the per actor tick mode)
+	if (bTickStateTimer) {
 		Timer -= DeltaTime;
-		if(Timer <= 0)
-			SwitchEnemyState(EEnemyState::ChaseIdle);
-		else
-			RetreatFromTarget();
+		if (Timer <= 0) {
+			SwitchEnemyState(TimerNextState);
+			return;
+		}
 	}
+
+	// The decision array computes retreat destinations for registered enemies
+	if (CurState == EEnemyState::Retreating && !DecisionSubsystem)
+		RetreatFromTarget();
 }
 
 
@@ -74,13 +165,28 @@ void AEnemyAIController::Tick(float DeltaTime) {
 void AEnemyAIController::SwitchEnemyState(EEnemyState NewState) {
 
 	CurState = NewState;
+	if (DecisionSubsystem)
+		DecisionSubsystem->SetState(DecisionId, NewState);
+	INC_DWORD_STAT(STAT_LockOnEnemyStateSwitches);
+	CSV_CUSTOM_STAT(EnemyAI, StateSwitches, 1, ECsvCustomStatOp::Accumulate);
+
+	ClearStateTimer();
+	if (PathRequestSubsystem)
+		PathRequestSubsystem->CancelRequests(this);
+	if (ChaseFlowField)
+		ChaseFlowField->RemoveChaser(this);
+
+	// Queued and flow field moves take frames to start, the previous state's path mustn't finish in between
+	//	and be taken as this state's move completing
+	if (GetMoveStatus() != EPathFollowingStatus::Idle)
+		StopMovement();
 
 	// *** Setup New State
 	switch (CurState) {
 
 		case EEnemyState::RoamIdle:
-			Timer = FMath::FRandRange(
-				RoamBaseWaitTime - RoamWaitTimeRandomness, RoamBaseWaitTime + RoamWaitTimeRandomness);;
+			StartStateTimer(RandomStream.FRandRange(
+				RoamBaseWaitTime - RoamWaitTimeRandomness, RoamBaseWaitTime + RoamWaitTimeRandomness), EEnemyState::Roaming);
 			break;
 
 		case EEnemyState::Roaming:
@@ -90,17 +196,20 @@ void AEnemyAIController::SwitchEnemyState(EEnemyState NewState) {
 		case EEnemyState::Chasing:
 			EnemyCharacter->SwitchMoveState(EEnemyMoveState::Chasing);
 			ClearFocus(EAIFocusPriority::Gameplay);
-			ChaseTarget();
+
+			// Steer along the shared flow field when possible, otherwise path to the target
+			if (!ChaseFlowField || !ChaseFlowField->AddChaser(this))
+				ChaseTarget();
 			break;
 
 		case EEnemyState::ChaseIdle:
-			Timer = FMath::FRandRange(
-				ChaseBaseWaitTime - ChaseWaitTimeRandomness, ChaseBaseWaitTime + ChaseWaitTimeRandomness);;
+			StartStateTimer(RandomStream.FRandRange(
+				ChaseBaseWaitTime - ChaseWaitTimeRandomness, ChaseBaseWaitTime + ChaseWaitTimeRandomness), EEnemyState::Chasing);
 			break;
 
 		case EEnemyState::Retreating:
 			EnemyCharacter->SwitchMoveState(EEnemyMoveState::Retreating);
-			Timer = MaxRetreatTime;
+			StartStateTimer(MaxRetreatTime, EEnemyState::ChaseIdle);
 			SetFocus(TargetActor);
 			RetreatFromTarget();
 			break;
@@ -109,6 +218,68 @@ void AEnemyAIController::SwitchEnemyState(EEnemyState NewState) {
 			EnemyCharacter->StartAttacking();
 			break;
 	}
+
+	// *** Only Tick in States That Update Every Frame
+	//	Chasing and Attacking need control rotation updates, Retreating moves every frame
+	SetActorTickEnabled(bTickStateTimer || CurState == EEnemyState::Chasing ||
+		CurState == EEnemyState::Retreating || CurState == EEnemyState::Attacking);
+}
+
+
+// Switches to the next state when the timer expires, only the per actor tick mode ticks while waiting
+void AEnemyAIController::StartStateTimer(float Duration, EEnemyState NextState) {
+
+	switch (UEnemyStateTimerSubsystem::GetTimerMode()) {
+
+		case EEnemyStateTimerMode::ActorTick:
+			Timer = Duration;
+			TimerNextState = NextState;
+			bTickStateTimer = true;
+			break;
+
+		case EEnemyStateTimerMode::TimerManager: {
+			FTimerDelegate timerDelegate = FTimerDelegate::CreateUObject(this, &AEnemyAIController::SwitchEnemyState, NextState);
+			GetWorldTimerManager().SetTimer(StateTimerHandle, timerDelegate, FMath::Max(Duration, KINDA_SMALL_NUMBER), false);
+			break;
+		}
+
+		case EEnemyStateTimerMode::TimerWheel:
+			if (StateTimerSubsystem)
+				StateTimerWheelHandle = StateTimerSubsystem->ScheduleStateTimer(this, Duration, NextState);
+			break;
+
+		case EEnemyStateTimerMode::DecisionArray:
+			if (DecisionSubsystem) {
+				DecisionSubsystem->StartTimer(DecisionId, Duration, NextState);
+			}
+			else {		// Not registered (LockOn.UseEnemyDecisionArray 0), count down in the actor tick
+				Timer = Duration;
+				TimerNextState = NextState;
+				bTickStateTimer = true;
+			}
+			break;
+	}
+}
+
+
+// Cancels the pending state timer in whichever mode started it
+void AEnemyAIController::ClearStateTimer() {
+
+	bTickStateTimer = false;
+	GetWorldTimerManager().ClearTimer(StateTimerHandle);
+
+	if (StateTimerSubsystem)
+		StateTimerSubsystem->CancelStateTimer(StateTimerWheelHandle);
+
+	if (DecisionSubsystem)
+		DecisionSubsystem->ClearTimer(DecisionId);
+}
+
+
+void AEnemyAIController::OnStateTimerExpired(EEnemyState NextState) {
+
+	StateTimerWheelHandle.Invalidate();
+	SwitchEnemyState(NextState);
 }
 
 
@@ -119,6 +290,9 @@ void AEnemyAIController::OnMoveCompleted(FAIRequestID RequestID, const FPathFoll
 	// Ignore when path is aborted
 	if (Result.Code == EPathFollowingResult::Aborted) return;
 
+	// Flow field chasers arrive through OnFlowFieldChaseArrived, any path finishing now is from an earlier state
+	if (ChaseFlowField && ChaseFlowField->IsChaser(this)) return;
+
 	if (CurState == EEnemyState::Roaming)
 		SwitchEnemyState(EEnemyState::RoamIdle);
 	
@@ -135,7 +309,19 @@ void AEnemyAIController::OnTargetPerception(AActor* Actor, FAIStimulus Stimulus)
 	
 	if (!Cast<APlayerCharacter>(Actor))	return;		// Only update perception on player
 
-	if (Stimulus.WasSuccessfullySensed()) {			// If found target
+	// Shared perception drives combat, component events are only used to validate it
+	if (PerceptionSubsystem) {
+		PerceptionSubsystem->ValidateComponentEvent(this, Stimulus.WasSuccessfullySensed());
+		return;
+	}
+
+	HandleTargetPerception(Actor, Stimulus.WasSuccessfullySensed());
+}
+
+
+void AEnemyAIController::HandleTargetPerception(AActor* Actor, bool bSensed) {
+
+	if (bSensed) {									// If found target
 
 		// *** Start Combat Mode
 		TargetActor = Actor;
@@ -155,10 +341,10 @@ void AEnemyAIController::OnTargetPerception(AActor* Actor, FAIStimulus Stimulus)
 // Moves to a random location in the nav mesh bounds within the roam radius
 void AEnemyAIController::MoveToRandomLocation() {
 
-	// *** Move to Random Location
-	FNavLocation result;
-	if (NavSystem->GetRandomReachablePointInRadius(GetPawn()->GetActorLocation(), RoamRadius, result)) {
-		MoveToLocation(result);
+	// *** Move to Random Location (taken from the region's cached pool when possible)
+	FVector roamPoint;
+	if (RoamPointSubsystem && RoamPointSubsystem->GetRoamPoint(GetPawn()->GetActorLocation(), roamPoint)) {
+		MoveToLocation(roamPoint);
 	}
 }
 
@@ -168,7 +354,14 @@ void AEnemyAIController::ChaseTarget() {
 
 	if (!TargetActor) return;
 
-	MoveToActor(TargetActor, 100.0f);
+	FAIMoveRequest moveRequest(TargetActor);
+	moveRequest.SetAcceptanceRadius(100.0f);
+	moveRequest.SetNavigationFilter(DefaultNavigationFilterClass);
+
+	if (PathRequestSubsystem)
+		PathRequestSubsystem->RequestMove(this, moveRequest);
+	else
+		MoveTo(moveRequest);
 }
 
 
@@ -181,9 +374,50 @@ void AEnemyAIController::RetreatFromTarget() {
 	FVector retreatDirection = 
 		(GetPawn()->GetActorLocation() - TargetActor->GetActorLocation()).GetSafeNormal2D();
 
-	FVector retreatLocation = TargetActor->GetActorLocation() + (retreatDirection * RetreatDistance);
+	MoveToRetreatLocation(TargetActor->GetActorLocation() + (retreatDirection * RetreatDistance));
+}
+
+
+// Called every frame while retreating, the path subsystem drops requests that barely moved the destination
+void AEnemyAIController::MoveToRetreatLocation(const FVector& RetreatLocation) {
+
+	FAIMoveRequest moveRequest(RetreatLocation);
+	moveRequest.SetNavigationFilter(DefaultNavigationFilterClass);
+
+	if (PathRequestSubsystem)
+		PathRequestSubsystem->RequestMove(this, moveRequest);
+	else
+		MoveTo(moveRequest);
+}
+
+
+void AEnemyAIController::OnFlowFieldChaseArrived() {
+
+	if (CurState == EEnemyState::Chasing)
+		SwitchEnemyState(EEnemyState::Attacking);
+}
+
+
+void AEnemyAIController::OnFlowFieldChaseLost() {
+
+	if (CurState == EEnemyState::Chasing)
+		ChaseTarget();
+}
+
+
+bool AEnemyAIController::BuildPathQuery(const FAIMoveRequest& MoveRequest, FPathFindingQuery& OutQuery) const {
+	return BuildPathfindingQuery(MoveRequest, OutQuery);
+}
+
+
+// Starts following a path found by the path request subsystem
+void AEnemyAIController::OnAsyncPathFound(const FAIMoveRequest& MoveRequest, FNavPathSharedPtr Path) {
+
+	// Keep the path updated while the goal actor moves, like MoveToActor does
+	if (MoveRequest.IsMoveToActorRequest() && MoveRequest.GetGoalActor())
+		Path->SetGoalActorObservation(*MoveRequest.GetGoalActor(), 100.0f);
 
-	MoveToLocation(retreatLocation);
+	RequestMove(MoveRequest, Path);
 }
 
 
@@ -0,0 +1,85 @@
+/*
+* Author: Eyan Martucci
+* Description: Stat group, counters, CSV categories and memory tracking tags shared by the gameplay code
+*/
+
+#include "LockOnTargetingStats.h"
+
+// *** Hot Path Timers
+DEFINE_STAT(STAT_LockOnTargetingTick);
+DEFINE_STAT(STAT_LockOnTargetSelection);
+DEFINE_STAT(STAT_LockOnPlayerTick);
+DEFINE_STAT(STAT_LockOnArrowUpdate);
+DEFINE_STAT(STAT_LockOnEnemyAITick);
+DEFINE_STAT(STAT_LockOnStateTimerWheel);
+DEFINE_STAT(STAT_LockOnRoamPointRefill);
+DEFINE_STAT(STAT_LockOnPathRequests);
+DEFINE_STAT(STAT_LockOnFlowFieldUpdate);
+DEFINE_STAT(STAT_LockOnPerceptionUpdate);
+DEFINE_STAT(STAT_LockOnEnemyProxyUpdate);
+DEFINE_STAT(STAT_LockOnEnemyProxySwaps);
+DEFINE_STAT(STAT_LockOnEnemyDecisions);
+DEFINE_STAT(STAT_LockOnEnemySpawn);
+DEFINE_STAT(STAT_LockOnScreenProjection);
+DEFINE_STAT(STAT_LockOnPlayerAnimUpdate);
+DEFINE_STAT(STAT_LockOnEnemyAnimUpdate);
+
+// *** Target Queries
+DEFINE_STAT(STAT_LockOnTargetQueries);
+DEFINE_STAT(STAT_LockOnRegistryQueries);
+DEFINE_STAT(STAT_LockOnCandidatesScanned);
+DEFINE_STAT(STAT_LockOnTargetQueryAllocations);
+DEFINE_STAT(STAT_LockOnTargetsOccluded);
+DEFINE_STAT(STAT_LockOnVisibilityTraces);
+DEFINE_STAT(STAT_LockOnTargetRankingRefreshes);
+DEFINE_STAT(STAT_LockOnRetargets);
+DEFINE_STAT(STAT_LockOnTargetsProjected);
+DEFINE_STAT(STAT_LockOnTargetsOnScreen);
+DEFINE_STAT(STAT_LockOnTargetQueryScratchMemory);
+
+// *** Non-Targeting Arrow Updates
+DEFINE_STAT(STAT_LockOnNonTargetingTriggered);
+DEFINE_STAT(STAT_LockOnNonTargetingSkipped);
+
+// *** Enemy AI and Animation
+DEFINE_STAT(STAT_LockOnEnemyStateSwitches);
+DEFINE_STAT(STAT_LockOnStateTimersFired);
+DEFINE_STAT(STAT_LockOnStateTimersPending);
+DEFINE_STAT(STAT_LockOnRoamPointRequests);
+DEFINE_STAT(STAT_LockOnRoamPointMisses);
+DEFINE_STAT(STAT_LockOnRoamPointHitRate);
+DEFINE_STAT(STAT_LockOnRoamPointWorstFrameMs);
+DEFINE_STAT(STAT_LockOnPathRequestsQueued);
+DEFINE_STAT(STAT_LockOnPathRequestsCoalesced);
+DEFINE_STAT(STAT_LockOnPathRequestsIssued);
+DEFINE_STAT(STAT_LockOnPathRequestsPending);
+DEFINE_STAT(STAT_LockOnFlowFieldCellsSampled);
+DEFINE_STAT(STAT_LockOnFlowFieldRebuilds);
+DEFINE_STAT(STAT_LockOnFlowFieldChasers);
+DEFINE_STAT(STAT_LockOnPerceptionInCone);
+DEFINE_STAT(STAT_LockOnPerceptionTraces);
+DEFINE_STAT(STAT_LockOnPerceptionValidationMatches);
+DEFINE_STAT(STAT_LockOnPerceptionValidationMismatches);
+DEFINE_STAT(STAT_LockOnEnemyProxies);
+DEFINE_STAT(STAT_LockOnEnemyProxyPromotions);
+DEFINE_STAT(STAT_LockOnEnemyProxyDemotions);
+DEFINE_STAT(STAT_LockOnEnemyPoolHits);
+DEFINE_STAT(STAT_LockOnEnemyPoolMisses);
+DEFINE_STAT(STAT_LockOnEnemyPoolFree);
+DEFINE_STAT(STAT_LockOnEnemyDecisionStates);
+DEFINE_STAT(STAT_LockOnEnemyDecisionActions);
+DEFINE_STAT(STAT_LockOnInputLatencyCameraP50);
+DEFINE_STAT(STAT_LockOnInputLatencyCameraP95);
+DEFINE_STAT(STAT_LockOnInputLatencyCameraP95Ms);
+DEFINE_STAT(STAT_LockOnInputLatencyArrowP50);
+DEFINE_STAT(STAT_LockOnInputLatencyArrowP95);
+DEFINE_STAT(STAT_LockOnInputLatencyRotationP50);
+DEFINE_STAT(STAT_LockOnInputLatencyRotationP95);
+DEFINE_STAT(STAT_LockOnMontagePlays);
+
+// *** CSV Categories
+CSV_DEFINE_CATEGORY_MODULE(ENEMYLOCKONTARGETING_API, LockOnTargeting, true);
+CSV_DEFINE_CATEGORY_MODULE(ENEMYLOCKONTARGETING_API, EnemyAI, true);
+CSV_DEFINE_CATEGORY_MODULE(ENEMYLOCKONTARGETING_API, GameplayAnim, true);
+
+LLM_DEFINE_TAG(LockOnTargeting);
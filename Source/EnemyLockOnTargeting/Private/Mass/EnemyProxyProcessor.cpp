@@ -0,0 +1,96 @@
+/*
+* Author: Eyan Martucci
+* Description: Moves background enemies through RoamIdle and Roaming in parallel.
+*	Proxies roam in straight lines without the navmesh, they are projected onto it when promoted.
+*/
+
+#include "Mass/EnemyProxyProcessor.h"
+
+#include "Mass/EnemyProxyFragments.h"		// For FEnemyProxyFragment
+#include "MassCommonFragments.h"			// For FTransformFragment
+#include "MassMovementFragments.h"			// For FMassVelocityFragment
+#include "MassCommonTypes.h"				// For processor group names
+#include "MassExecutionContext.h"			// For FMassExecutionContext
+#include "LockOnTargetingStats.h"			// For proxy stats
+
+
+UEnemyProxyProcessor::UEnemyProxyProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = true;
+	bRequiresGameThreadExecution = false;
+	ExecutionFlags = (int32)EProcessorExecutionFlags::AllNetModes;
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+	ExecutionOrder.ExecuteInGroup = UE::Mass::ProcessorGroupNames::Movement;
+}
+
+
+void UEnemyProxyProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) {
+
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMassVelocityFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FEnemyProxyFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddTagRequirement<FEnemyProxyTag>(EMassFragmentPresence::All);
+}
+
+
+// Every entity only touches its own fragments, so chunks run on worker threads
+void UEnemyProxyProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) {
+	LOCKON_SCOPED_TIMER(STAT_LockOnEnemyProxyUpdate, EnemyAI, EnemyProxyUpdate);
+
+	EntityQuery.ParallelForEachEntityChunk(Context, [this](FMassExecutionContext& Context) {
+
+		const float deltaTime = Context.GetDeltaTimeSeconds();
+		const TArrayView<FTransformFragment> transforms = Context.GetMutableFragmentView<FTransformFragment>();
+		const TArrayView<FMassVelocityFragment> velocities = Context.GetMutableFragmentView<FMassVelocityFragment>();
+		const TArrayView<FEnemyProxyFragment> proxies = Context.GetMutableFragmentView<FEnemyProxyFragment>();
+
+		for (int32 i = 0; i < Context.GetNumEntities(); i++) {
+
+			FTransform& transform = transforms[i].GetMutableTransform();
+			FVector& velocity = velocities[i].Value;
+			FEnemyProxyFragment& proxy = proxies[i];
+
+			switch (proxy.State) {
+
+				// *** Wait, Then Pick a Random Roam Target
+				case EEnemyState::RoamIdle: {
+					velocity = FVector::ZeroVector;
+					proxy.StateTimer -= deltaTime;
+					if (proxy.StateTimer > 0.0f) break;
+
+					const float angle = proxy.RandomStream.FRandRange(0.0f, UE_TWO_PI);
+					const float radius = proxy.RandomStream.FRandRange(0.0f, RoamRadius);
+					proxy.RoamTarget = proxy.HomeLocation + FVector(FMath::Cos(angle) * radius, FMath::Sin(angle) * radius, 0.0f);
+					proxy.State = EEnemyState::Roaming;
+					break;
+				}
+
+				// *** Move Toward the Roam Target
+				case EEnemyState::Roaming: {
+					FVector toTarget = proxy.RoamTarget - transform.GetLocation();
+					toTarget.Z = 0.0f;
+					const float distance = toTarget.Size();
+
+					if (distance <= AcceptanceRadius) {
+						proxy.State = EEnemyState::RoamIdle;
+						proxy.StateTimer = proxy.RandomStream.FRandRange(
+							RoamBaseWaitTime - RoamWaitTimeRandomness, RoamBaseWaitTime + RoamWaitTimeRandomness);
+						velocity = FVector::ZeroVector;
+						break;
+					}
+
+					velocity = toTarget / distance * RoamSpeed;
+					transform.SetLocation(transform.GetLocation() + velocity * FMath::Min(deltaTime, distance / RoamSpeed));
+					transform.SetRotation(velocity.ToOrientationQuat());
+					break;
+				}
+
+				// Combat states only exist on promoted actors
+				default:
+					proxy.State = EEnemyState::RoamIdle;
+					break;
+			}
+		}
+	});
+}
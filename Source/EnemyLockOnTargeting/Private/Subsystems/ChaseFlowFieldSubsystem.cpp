@@ -0,0 +1,329 @@
+/*
+* Author: Eyan Martucci
+* Description: Builds one distance field on a grid around the player so chasing enemies can steer
+*	toward them by sampling it, instead of each enemy finding and following its own path.
+*	Navmesh walkability is sampled per cell under a budget and cached, the distance field is rebuilt
+*	in full when the player enters a new cell or newly sampled cells change it.
+*/
+
+#include "Subsystems/ChaseFlowFieldSubsystem.h"
+
+#include "Controllers/EnemyAIController.h"		// For AEnemyAIController
+#include "NavigationSystem.h"					// For ProjectPointToNavigation
+#include "Kismet/GameplayStatics.h"				// For GetPlayerPawn
+#include "HAL/IConsoleManager.h"				// For console variables
+#include "LockOnTargetingStats.h"				// For flow field stats
+
+
+static TAutoConsoleVariable<bool> CVarUseChaseFlowField(
+	TEXT("LockOn.UseChaseFlowField"), true,
+	TEXT("If true, chasing enemies steer along a shared flow field to the player instead of following individual paths."));
+
+static TAutoConsoleVariable<int32> CVarFlowFieldSamplesPerFrame(
+	TEXT("LockOn.FlowFieldSamplesPerFrame"), 256,
+	TEXT("Maximum number of flow field cells projected onto the navmesh per frame."));
+
+// Neighbour offsets, the first four are orthogonal
+static const FIntPoint NeighbourOffsets[8] = {
+	{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+	{ 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 }
+};
+
+
+TStatId UChaseFlowFieldSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UChaseFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+
+bool UChaseFlowFieldSubsystem::IsEnabled() {
+	return CVarUseChaseFlowField.GetValueOnGameThread();
+}
+
+
+// Follows the player, samples new cells, rebuilds the field when needed and steers the chasers
+void UChaseFlowFieldSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+	LOCKON_SCOPED_TIMER(STAT_LockOnFlowFieldUpdate, EnemyAI, FlowFieldUpdate);
+
+	APawn* player = UGameplayStatics::GetPlayerPawn(this, 0);
+	if (!IsEnabled() || !player) {
+		bHasField = false;
+		SteerChasers();		// Hands every chaser back to pathfinding
+		return;
+	}
+
+	// *** Recenter the Field When the Player Enters a New Cell
+	GoalActor = player;
+	FIntPoint playerCell = GetCellCoord(player->GetActorLocation());
+	bool bGoalMoved = !bHasField || playerCell != GoalCell;
+
+	// *** Size the Sample Cache to the Field (slots start unsampled)
+	const int32 numCells = GetFieldWidth() * GetFieldWidth();
+	if (SampledCells.Num() != numCells) {
+		SampledCells.Init(FIntPoint(MAX_int32, MAX_int32), numCells);
+		SampledHeights.Init(NAN, numCells);
+	}
+
+	if (bGoalMoved) {
+		GoalCell = playerCell;
+		FieldMin = GoalCell - FIntPoint(FieldHalfCells, FieldHalfCells);
+		SampleRing = 0;
+	}
+
+	SampleCells(player->GetActorLocation());
+
+	// *** Rebuild
+	TimeSinceRebuild += DeltaTime;
+	if (bGoalMoved || (bFieldDirty && TimeSinceRebuild >= MinRebuildInterval))
+		RebuildField();
+
+	SteerChasers();
+}
+
+
+bool UChaseFlowFieldSubsystem::AddChaser(AEnemyAIController* Controller) {
+
+	if (!IsEnabled() || !Controller || !Controller->GetPawn()) return false;
+
+	FVector direction;
+	if (!GetChaseDirection(Controller->GetPawn()->GetActorLocation(), Controller->GetTargetActor(), direction))
+		return false;
+
+	Chasers.AddUnique(Controller);
+	SET_DWORD_STAT(STAT_LockOnFlowFieldChasers, Chasers.Num());
+	return true;
+}
+
+
+void UChaseFlowFieldSubsystem::RemoveChaser(AEnemyAIController* Controller) {
+	Chasers.RemoveSwap(Controller, EAllowShrinking::No);
+}
+
+
+bool UChaseFlowFieldSubsystem::IsChaser(const AEnemyAIController* Controller) const {
+	return Chasers.Contains(Controller);
+}
+
+
+// Adds movement input for every chaser each frame (so tick LOD on the controllers doesn't slow them down)
+void UChaseFlowFieldSubsystem::SteerChasers() {
+
+	TArray<AEnemyAIController*, TInlineAllocator<32>> arrived;
+	TArray<AEnemyAIController*, TInlineAllocator<32>> lost;
+
+	for (int32 i = Chasers.Num() - 1; i >= 0; i--) {
+
+		AEnemyAIController* controller = Chasers[i].Get();
+		APawn* pawn = controller ? controller->GetPawn() : nullptr;
+		AActor* target = controller ? controller->GetTargetActor() : nullptr;
+
+		if (!pawn) {
+			Chasers.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		// *** Arrived
+		float acceptance = ChaseAcceptanceRadius + pawn->GetSimpleCollisionRadius() + (target ? target->GetSimpleCollisionRadius() : 0.0f);
+		if (target && FVector::DistSquared2D(pawn->GetActorLocation(), target->GetActorLocation()) <= FMath::Square(acceptance)) {
+			arrived.Add(controller);
+			Chasers.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		// *** Steer, or Hand Back to Pathfinding When Outside the Field
+		FVector direction;
+		if (bHasField && GetChaseDirection(pawn->GetActorLocation(), target, direction)) {
+			pawn->AddMovementInput(direction);
+		}
+		else {
+			lost.Add(controller);
+			Chasers.RemoveAtSwap(i, EAllowShrinking::No);
+		}
+	}
+
+	// Callbacks switch state and can add or remove chasers, so they run after the loop
+	for (AEnemyAIController* controller : arrived)
+		controller->OnFlowFieldChaseArrived();
+	for (AEnemyAIController* controller : lost)
+		controller->OnFlowFieldChaseLost();
+
+	SET_DWORD_STAT(STAT_LockOnFlowFieldChasers, Chasers.Num());
+}
+
+
+// Moves toward the lowest cost neighbouring cell
+bool UChaseFlowFieldSubsystem::GetChaseDirection(const FVector& Location, const AActor* Target, FVector& OutDirection) const {
+
+	if (!bHasField || !Target || Target != GoalActor) return false;
+
+	FIntPoint cell = GetCellCoord(Location);
+	int32 index = GetFieldIndex(cell);
+	if (index == INDEX_NONE || Costs[index] == MAX_flt) return false;
+
+	if (cell == GoalCell) {
+		OutDirection = (Target->GetActorLocation() - Location).GetSafeNormal2D();
+		return true;
+	}
+
+	// *** Find the Connected Neighbour Closest to the Goal
+	float bestCost = Costs[index];
+	FIntPoint bestCell = cell;
+
+	for (const FIntPoint& offset : NeighbourOffsets) {
+		FIntPoint neighbour = cell + offset;
+		int32 neighbourIndex = GetFieldIndex(neighbour);
+
+		if (neighbourIndex != INDEX_NONE && Costs[neighbourIndex] < bestCost && AreCellsConnected(cell, neighbour)) {
+			bestCost = Costs[neighbourIndex];
+			bestCell = neighbour;
+		}
+	}
+
+	if (bestCell == cell) return false;
+
+	FVector cellCenter((bestCell.X + 0.5f) * CellSize, (bestCell.Y + 0.5f) * CellSize, Location.Z);
+	OutDirection = (cellCenter - Location).GetSafeNormal2D();
+	return true;
+}
+
+
+int32 UChaseFlowFieldSubsystem::GetFieldIndex(const FIntPoint& Cell) const {
+
+	FIntPoint local = Cell - FieldMin;
+	if (local.X < 0 || local.Y < 0 || local.X >= GetFieldWidth() || local.Y >= GetFieldWidth())
+		return INDEX_NONE;
+
+	return local.Y * GetFieldWidth() + local.X;
+}
+
+
+// Samples unsampled cells ring by ring outward from the goal, so the cells nearest the player are ready first
+void UChaseFlowFieldSubsystem::SampleCells(const FVector& GoalLocation) {
+
+	UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!navSystem) return;
+
+	int32 budget = CVarFlowFieldSamplesPerFrame.GetValueOnGameThread();
+	const FVector extent(CellSize * 0.5f, CellSize * 0.5f, MaxStepHeight * 4.0f);
+
+	for (; SampleRing <= FieldHalfCells; SampleRing++) {
+		const int32 ring = SampleRing;
+
+		for (int32 y = -ring; y <= ring; y++) {
+			// Inner rows only have the two edge cells
+			const int32 xStep = (FMath::Abs(y) == ring) ? 1 : FMath::Max(ring * 2, 1);
+
+			for (int32 x = -ring; x <= ring; x += xStep) {
+				FIntPoint cell = GoalCell + FIntPoint(x, y);
+				const int32 slot = GetSampleSlot(cell);
+				if (SampledCells[slot] == cell) continue;
+
+				if (budget-- <= 0) return;
+
+				FNavLocation projected;
+				FVector cellCenter((cell.X + 0.5f) * CellSize, (cell.Y + 0.5f) * CellSize, GoalLocation.Z);
+				bool bWalkable = navSystem->ProjectPointToNavigation(cellCenter, projected, extent);
+
+				SampledCells[slot] = cell;		// Overwrites a cell that has left the field
+				SampledHeights[slot] = bWalkable ? (float)projected.Location.Z : NAN;
+				bFieldDirty = true;
+				INC_DWORD_STAT(STAT_LockOnFlowFieldCellsSampled);
+			}
+		}
+	}
+}
+
+
+// Dijkstra over the field from the goal cell, diagonal steps need both orthogonal cells to be open
+void UChaseFlowFieldSubsystem::RebuildField() {
+
+	INC_DWORD_STAT(STAT_LockOnFlowFieldRebuilds);
+
+	const int32 width = GetFieldWidth();
+	Costs.Init(MAX_flt, width * width);
+
+	// *** Copy Heights Into Field Order, So the Pass Only Indexes Flat Arrays
+	FieldHeights.SetNumUninitialized(width * width, EAllowShrinking::No);
+	for (int32 y = 0; y < width; y++) {
+		for (int32 x = 0; x < width; x++)
+			FieldHeights[y * width + x] = GetSampledHeight(FieldMin + FIntPoint(x, y));
+	}
+
+	auto isConnected = [this](int32 From, int32 To) {
+		const float fromHeight = FieldHeights[From];
+		const float toHeight = FieldHeights[To];
+		return !FMath::IsNaN(fromHeight) && !FMath::IsNaN(toHeight) && FMath::Abs(fromHeight - toHeight) <= MaxStepHeight;
+	};
+
+	TArray<TPair<float, int32>> open;
+	auto heapPredicate = [](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; };
+
+	int32 goalIndex = GetFieldIndex(GoalCell);
+	Costs[goalIndex] = 0.0f;
+	open.HeapPush(TPair<float, int32>(0.0f, goalIndex), heapPredicate);
+
+	while (open.Num() > 0) {
+		TPair<float, int32> current;
+		open.HeapPop(current, heapPredicate, EAllowShrinking::No);
+		if (current.Key > Costs[current.Value]) continue;		// Already reached more cheaply
+
+		const int32 x = current.Value % width;
+		const int32 y = current.Value / width;
+
+		for (int32 i = 0; i < 8; i++) {
+			const FIntPoint& offset = NeighbourOffsets[i];
+			const int32 neighbourX = x + offset.X;
+			const int32 neighbourY = y + offset.Y;
+			if (neighbourX < 0 || neighbourY < 0 || neighbourX >= width || neighbourY >= width) continue;
+
+			const int32 neighbourIndex = neighbourY * width + neighbourX;
+			if (!isConnected(current.Value, neighbourIndex)) continue;
+
+			// Both orthogonal cells are inside the field whenever the diagonal one is
+			bool bDiagonal = i >= 4;
+			if (bDiagonal && (!isConnected(current.Value, y * width + neighbourX) ||
+				!isConnected(current.Value, neighbourY * width + x)))
+				continue;
+
+			float cost = current.Key + (bDiagonal ? UE_SQRT_2 : 1.0f);
+			if (cost < Costs[neighbourIndex]) {
+				Costs[neighbourIndex] = cost;
+				open.HeapPush(TPair<float, int32>(cost, neighbourIndex), heapPredicate);
+			}
+		}
+	}
+
+	bHasField = true;
+	bFieldDirty = false;
+	TimeSinceRebuild = 0.0f;
+}
+
+
+// Both cells are walkable and the step between them is small enough
+bool UChaseFlowFieldSubsystem::AreCellsConnected(const FIntPoint& From, const FIntPoint& To) const {
+
+	const float fromHeight = GetSampledHeight(From);
+	const float toHeight = GetSampledHeight(To);
+	if (FMath::IsNaN(fromHeight) || FMath::IsNaN(toHeight))
+		return false;
+
+	return FMath::Abs(fromHeight - toHeight) <= MaxStepHeight;
+}
+
+
+int32 UChaseFlowFieldSubsystem::GetSampleSlot(const FIntPoint& Cell) const {
+
+	const int32 width = GetFieldWidth();
+	const int32 x = ((Cell.X % width) + width) % width;		// Negative cells wrap too
+	const int32 y = ((Cell.Y % width) + width) % width;
+	return y * width + x;
+}
+
+
+float UChaseFlowFieldSubsystem::GetSampledHeight(const FIntPoint& Cell) const {
+
+	if (SampledCells.Num() == 0) return NAN;
+
+	const int32 slot = GetSampleSlot(Cell);
+	return SampledCells[slot] == Cell ? SampledHeights[slot] : NAN;
+}
@@ -0,0 +1,90 @@
+/*
+* Author: Eyan Martucci
+* Description: Opt in deterministic simulation for reproducible benchmark and soak runs. The engine
+*	advances with a fixed delta time as fast as it can (no frame rate cap), the global random seed is
+*	fixed, and every enemy gets its own seeded random stream.
+*	Enable with -LockOnDeterministic [-LockOnSeed=1337] [-LockOnFixedFps=60] or LockOn.DeterministicSim 1 before loading a level.
+*/
+
+#include "Subsystems/DeterministicSimSubsystem.h"
+
+#include "Misc/App.h"						// For FApp fixed time step
+#include "Misc/CommandLine.h"				// For FCommandLine
+#include "Misc/Parse.h"						// For FParse
+#include "HAL/IConsoleManager.h"			// For console variables
+
+
+static TAutoConsoleVariable<bool> CVarDeterministicSim(
+	TEXT("LockOn.DeterministicSim"), false,
+	TEXT("If true, the next level runs with a fixed time step, uncapped frame rate and seeded random streams."));
+
+static TAutoConsoleVariable<int32> CVarDeterministicSeed(
+	TEXT("LockOn.DeterministicSeed"), 1337,
+	TEXT("Seed used by the deterministic simulation (overridden by -LockOnSeed=)."));
+
+static TAutoConsoleVariable<float> CVarDeterministicFixedFps(
+	TEXT("LockOn.DeterministicFixedFps"), 60.0f,
+	TEXT("Simulated frames per second of the deterministic simulation (overridden by -LockOnFixedFps=)."));
+
+static bool bDeterministicSimActive = false;
+
+
+bool UDeterministicSimSubsystem::IsEnabled() {
+	return bDeterministicSimActive;
+}
+
+
+void UDeterministicSimSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	if (!GetWorld()->IsGameWorld()) return;		// Editor and preview worlds leave the running game alone
+	bDeterministicSimActive = false;
+
+	if (!CVarDeterministicSim.GetValueOnGameThread() && !FParse::Param(FCommandLine::Get(), TEXT("LockOnDeterministic")))
+		return;
+
+	// *** Read Settings (command line wins over console variables)
+	Seed = (uint32)CVarDeterministicSeed.GetValueOnGameThread();
+	FParse::Value(FCommandLine::Get(), TEXT("LockOnSeed="), Seed);
+
+	float fixedFps = CVarDeterministicFixedFps.GetValueOnGameThread();
+	FParse::Value(FCommandLine::Get(), TEXT("LockOnFixedFps="), fixedFps);
+	FixedDeltaTime = 1.0f / FMath::Max(fixedFps, 1.0f);
+
+	// *** Fixed Time Step (the engine doesn't wait between frames in this mode, so it runs uncapped)
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(FixedDeltaTime);
+	bAppliedFixedTimeStep = true;
+
+	// *** Seed the Global Random Stream (navmesh random points and anything else using FMath::Rand)
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+	NextStreamIndex = 0;
+
+	bDeterministicSimActive = true;
+	UE_LOG(LogTemp, Display, TEXT("Deterministic simulation: seed %u, fixed step %.4fs"), Seed, FixedDeltaTime);
+}
+
+
+void UDeterministicSimSubsystem::Deinitialize() {
+
+	if (bAppliedFixedTimeStep) {
+		FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+		bAppliedFixedTimeStep = false;
+		bDeterministicSimActive = false;
+	}
+
+	Super::Deinitialize();
+}
+
+
+FRandomStream UDeterministicSimSubsystem::CreateRandomStream() {
+
+	if (!bDeterministicSimActive)
+		return FRandomStream(FMath::Rand());
+
+	return FRandomStream((int32)HashCombine(Seed, NextStreamIndex++));
+}
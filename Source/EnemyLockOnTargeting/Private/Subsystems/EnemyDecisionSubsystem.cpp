@@ -0,0 +1,250 @@
+/*
+* Author: Eyan Martucci
+* Description: Packed per enemy decision state updated with ParallelFor. Only enemies with work (retreating
+*	or with a decision timer running) are in the active list. Their locations are gathered on the game thread,
+*	state timers and retreat destinations are computed on worker threads, and the results are applied on
+*	the game thread in a fixed order (state switches, move requests and montage starts).
+*/
+
+#include "Subsystems/EnemyDecisionSubsystem.h"
+
+#include "Async/ParallelFor.h"			// For ParallelFor
+#include "HAL/IConsoleManager.h"		// For console variables
+#include "LockOnTargetingStats.h"		// For decision stats
+
+
+static TAutoConsoleVariable<bool> CVarUseEnemyDecisionArray(
+	TEXT("LockOn.UseEnemyDecisionArray"), true,
+	TEXT("If true, per frame enemy decisions (retreat destinations, LockOn.EnemyStateTimerMode 3 timers) are updated in UEnemyDecisionSubsystem.\n")
+	TEXT("Read when an enemy's AI is activated."));
+
+static TAutoConsoleVariable<bool> CVarParallelEnemyDecisions(
+	TEXT("LockOn.ParallelEnemyDecisions"), true,
+	TEXT("If true, the decision array is updated on worker threads, otherwise on the game thread (for comparison)."));
+
+static TAutoConsoleVariable<int32> CVarEnemyDecisionBatchSize(
+	TEXT("LockOn.EnemyDecisionBatchSize"), 64,
+	TEXT("Number of enemies updated by each ParallelFor task."));
+
+
+TStatId UEnemyDecisionSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyDecisionSubsystem, STATGROUP_Tickables);
+}
+
+
+bool UEnemyDecisionSubsystem::IsEnabled() {
+	return CVarUseEnemyDecisionArray.GetValueOnGameThread();
+}
+
+
+void UEnemyDecisionSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+	LOCKON_SCOPED_TIMER(STAT_LockOnEnemyDecisions, EnemyAI, EnemyDecisions);
+
+	// *** Remove Active Controllers That Lost Their Pawn (inactive ones unregister in EndPlay)
+	for (int32 a = ActiveIndices.Num() - 1; a >= 0; a--) {
+		const int32 index = ActiveIndices[a];
+		if (!Controllers[index].IsValid() || !Controllers[index]->GetPawn())
+			RemoveEnemyAtSwap(index);
+	}
+
+	SET_DWORD_STAT(STAT_LockOnEnemyDecisionStates, ActiveIndices.Num());
+	if (ActiveIndices.Num() == 0) return;		// Idle and roaming enemies cost nothing here
+
+	GatherLocations();
+	UpdateDecisions(DeltaTime);
+	ApplyResults();
+}
+
+
+uint32 UEnemyDecisionSubsystem::RegisterEnemy(AEnemyAIController* Controller, float RetreatDistance) {
+
+	const uint32 id = NextEnemyId++;
+	IdToIndex.Add(id, Controllers.Num());
+
+	Controllers.Add(Controller);
+	EnemyIds.Add(id);
+
+	FEnemyDecisionState& state = States.AddDefaulted_GetRef();
+	state.RetreatDistance = RetreatDistance;
+	Results.AddDefaulted();
+	ActiveSlots.Add(INDEX_NONE);
+
+	return id;
+}
+
+
+void UEnemyDecisionSubsystem::UnregisterEnemy(uint32 Id) {
+
+	if (const int32* index = IdToIndex.Find(Id))
+		RemoveEnemyAtSwap(*index);
+}
+
+
+void UEnemyDecisionSubsystem::SetState(uint32 Id, EEnemyState NewState) {
+
+	if (const int32* index = IdToIndex.Find(Id)) {
+		States[*index].State = NewState;
+		States[*index].TimeSinceMove = MAX_flt;		// Retreating requests its first move right away
+		UpdateActive(*index);
+	}
+}
+
+
+void UEnemyDecisionSubsystem::StartTimer(uint32 Id, float Duration, EEnemyState NextState) {
+
+	if (const int32* index = IdToIndex.Find(Id)) {
+		FEnemyDecisionState& state = States[*index];
+		state.Timer = Duration;
+		state.TimerNextState = NextState;
+		state.bTimerActive = true;
+		UpdateActive(*index);
+	}
+}
+
+
+void UEnemyDecisionSubsystem::ClearTimer(uint32 Id) {
+
+	if (const int32* index = IdToIndex.Find(Id)) {
+		States[*index].bTimerActive = false;
+		UpdateActive(*index);
+	}
+}
+
+
+// Removes an enemy by moving the last one into its place
+void UEnemyDecisionSubsystem::RemoveEnemyAtSwap(int32 Index) {
+
+	UpdateActive(Index, true);
+	IdToIndex.Remove(EnemyIds[Index]);
+
+	const int32 lastIndex = Controllers.Num() - 1;
+	if (Index != lastIndex) {
+		IdToIndex[EnemyIds[lastIndex]] = Index;
+		if (ActiveSlots[lastIndex] != INDEX_NONE)
+			ActiveIndices[ActiveSlots[lastIndex]] = Index;
+	}
+
+	Controllers.RemoveAtSwap(Index, EAllowShrinking::No);
+	EnemyIds.RemoveAtSwap(Index, EAllowShrinking::No);
+	States.RemoveAtSwap(Index, EAllowShrinking::No);
+	Results.RemoveAtSwap(Index, EAllowShrinking::No);
+	ActiveSlots.RemoveAtSwap(Index, EAllowShrinking::No);
+}
+
+
+void UEnemyDecisionSubsystem::UpdateActive(int32 Index, bool bForceInactive) {
+
+	const FEnemyDecisionState& state = States[Index];
+	const bool bActive = !bForceInactive && (state.bTimerActive || state.State == EEnemyState::Retreating);
+	int32& slot = ActiveSlots[Index];
+
+	if (bActive && slot == INDEX_NONE) {
+		slot = ActiveIndices.Add(Index);
+	}
+	else if (!bActive && slot != INDEX_NONE) {
+		const int32 movedIndex = ActiveIndices.Last();
+		ActiveIndices.RemoveAtSwap(slot, EAllowShrinking::No);
+		if (movedIndex != Index)
+			ActiveSlots[movedIndex] = slot;
+		slot = INDEX_NONE;
+	}
+}
+
+
+// Copies the pawn and target locations of active enemies into the packed states (game thread only)
+void UEnemyDecisionSubsystem::GatherLocations() {
+
+	for (const int32 i : ActiveIndices) {
+
+		const AEnemyAIController* controller = Controllers[i].Get();
+		const AActor* target = controller->GetTargetActor();
+		FEnemyDecisionState& state = States[i];
+
+		state.PawnLocation = controller->GetPawn()->GetActorLocation();
+		state.MoveInterval = controller->GetActorTickInterval();		// Set by the enemy's tick LOD
+		state.bHasTarget = IsValid(target);
+		if (state.bHasTarget)
+			state.TargetLocation = target->GetActorLocation();
+	}
+}
+
+
+// Every enemy only writes its own state and result, so batches need no locking
+void UEnemyDecisionSubsystem::UpdateDecisions(float DeltaTime) {
+
+	const int32 numEnemies = ActiveIndices.Num();
+	const int32 batchSize = FMath::Max(CVarEnemyDecisionBatchSize.GetValueOnGameThread(), 1);
+	const int32 numBatches = FMath::DivideAndRoundUp(numEnemies, batchSize);
+
+	const EParallelForFlags flags = CVarParallelEnemyDecisions.GetValueOnGameThread() ?
+		EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+
+	ParallelFor(numBatches, [this, DeltaTime, batchSize, numEnemies](int32 batch) {
+
+		const int32 end = FMath::Min((batch + 1) * batchSize, numEnemies);
+		for (int32 a = batch * batchSize; a < end; a++) {
+			const int32 i = ActiveIndices[a];
+			UpdateDecision(States[i], Results[i], DeltaTime);
+		}
+
+	}, flags);
+}
+
+
+void UEnemyDecisionSubsystem::UpdateDecision(FEnemyDecisionState& State, FEnemyDecisionResult& Result, float DeltaTime) {
+
+	Result.bSwitchState = false;
+	Result.bMove = false;
+
+	// *** Count Down the State Timer
+	if (State.bTimerActive) {
+		State.Timer -= DeltaTime;
+
+		if (State.Timer <= 0.0f) {
+			State.bTimerActive = false;
+			Result.bSwitchState = true;
+			Result.NextState = State.TimerNextState;
+			return;
+		}
+	}
+
+	// *** Keep Retreat Distance From the Target (same math as AEnemyAIController::RetreatFromTarget)
+	//	Far enemies with a lower tick LOD request moves at their tick interval instead of every frame
+	State.TimeSinceMove += DeltaTime;
+	if (State.State == EEnemyState::Retreating && State.bHasTarget && State.TimeSinceMove >= State.MoveInterval) {
+
+		State.TimeSinceMove = 0.0f;
+
+		const FVector retreatDirection = (State.PawnLocation - State.TargetLocation).GetSafeNormal2D();
+		Result.MoveDestination = State.TargetLocation + (retreatDirection * State.RetreatDistance);
+		Result.bMove = true;
+	}
+}
+
+
+// Applies results in active list order on the game thread, handlers can switch state and start timers
+void UEnemyDecisionSubsystem::ApplyResults() {
+
+	TArray<TPair<AEnemyAIController*, FEnemyDecisionResult>, TInlineAllocator<32>> actions;
+
+	for (const int32 i : ActiveIndices) {
+		if (Results[i].bSwitchState || Results[i].bMove)
+			actions.Emplace(Controllers[i].Get(), Results[i]);
+	}
+
+	// *** Expired Timers Leave the Active List (walked backwards, removal swaps in an entry already visited)
+	for (int32 a = ActiveIndices.Num() - 1; a >= 0; a--)
+		UpdateActive(ActiveIndices[a]);
+
+	for (const TPair<AEnemyAIController*, FEnemyDecisionResult>& action : actions) {
+
+		if (action.Value.bSwitchState)
+			action.Key->OnStateTimerExpired(action.Value.NextState);
+		else
+			action.Key->MoveToRetreatLocation(action.Value.MoveDestination);
+	}
+
+	INC_DWORD_STAT_BY(STAT_LockOnEnemyDecisionActions, actions.Num());
+	CSV_CUSTOM_STAT(EnemyAI, EnemyDecisionActions, actions.Num(), ECsvCustomStatOp::Set);
+}
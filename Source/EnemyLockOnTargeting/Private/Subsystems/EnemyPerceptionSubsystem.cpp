@@ -0,0 +1,316 @@
+/*
+* Author: Eyan Martucci
+* Description: Shared sight perception for enemies. The player is the only stimulus source, so every
+*	frame all enemies are tested against the player with a 4 wide radius and cone prefilter, and
+*	only the enemies that pass get an async line of sight trace (within a per frame trace budget).
+*	Gained and lost sight events are sent to the controllers like the perception component did.
+*/
+
+#include "Subsystems/EnemyPerceptionSubsystem.h"
+
+#include "Controllers/EnemyAIController.h"		// For AEnemyAIController
+#include "Characters/PlayerCharacter.h"			// For APlayerCharacter
+#include "Kismet/GameplayStatics.h"				// For GetPlayerCharacter
+#include "Math/VectorRegister.h"				// For VectorRegister4Float
+#include "HAL/IConsoleManager.h"				// For console variables
+#include "LockOnTargetingStats.h"				// For perception stats
+
+
+static TAutoConsoleVariable<bool> CVarUseSharedPerception(
+	TEXT("LockOn.UseSharedPerception"), true,
+	TEXT("If true, enemy sight is handled by UEnemyPerceptionSubsystem instead of each controller's perception component.\n")
+	TEXT("Read when an enemy is possessed."));
+
+static TAutoConsoleVariable<bool> CVarValidateSharedPerception(
+	TEXT("LockOn.ValidateSharedPerception"), false,
+	TEXT("If true, the perception components keep running and every sight event they send is compared with the shared perception.\n")
+	TEXT("Read when an enemy is possessed."));
+
+static TAutoConsoleVariable<int32> CVarSightTracesPerFrame(
+	TEXT("LockOn.SightTracesPerFrame"), 32,
+	TEXT("Maximum number of async line of sight traces started per frame, listeners traced longest ago go first."));
+
+static const double SightValidationTolerance = 0.25;	// Traces land a frame late, so small timing differences aren't mismatches
+
+
+TStatId UEnemyPerceptionSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPerceptionSubsystem, STATGROUP_Tickables);
+}
+
+
+bool UEnemyPerceptionSubsystem::IsEnabled() {
+	return CVarUseSharedPerception.GetValueOnGameThread();
+}
+
+
+bool UEnemyPerceptionSubsystem::IsValidating() {
+	return CVarValidateSharedPerception.GetValueOnGameThread();
+}
+
+
+void UEnemyPerceptionSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	SightTraceDelegate.BindUObject(this, &UEnemyPerceptionSubsystem::OnSightTraceDone);
+}
+
+
+// Updates every listener's sight of the player and sends gained and lost sight events
+void UEnemyPerceptionSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+	LOCKON_SCOPED_TIMER(STAT_LockOnPerceptionUpdate, EnemyAI, PerceptionUpdate);
+
+	// *** Remove Destroyed Controllers
+	for (int32 i = Controllers.Num() - 1; i >= 0; i--) {
+		if (!Controllers[i].IsValid() || !Controllers[i]->GetPawn())
+			RemoveListenerAtSwap(i);
+	}
+
+	APlayerCharacter* player = Cast<APlayerCharacter>(UGameplayStatics::GetPlayerCharacter(this, 0));
+	const int32 numListeners = Controllers.Num();
+	if (!player || numListeners == 0) return;
+
+	const FVector playerLocation = player->GetActorLocation();
+	const double now = GetWorld()->GetTimeSeconds();
+
+	GatherListenerViews(playerLocation);
+	RunPrefilter(playerLocation);
+	IssueSightTraces(player);
+
+	// *** Update Sight State and Collect Events (sent after the loop since handlers switch state)
+	TArray<TPair<AEnemyAIController*, bool>, TInlineAllocator<32>> events;
+
+	for (int32 i = 0; i < numListeners; i++) {
+
+		const bool bNowVisible = bInCone[i] && bTraceVisible[i];
+		if (bNowVisible != bVisible[i]) {
+			bVisible[i] = bNowVisible;
+			LastVisibleChangeTime[i] = now;
+		}
+
+		if (bNowVisible) {
+			LastSeenTime[i] = now;
+			if (!bSensed[i]) {
+				bSensed[i] = true;
+				events.Emplace(Controllers[i].Get(), true);
+			}
+		}
+		else if (bSensed[i] && now - LastSeenTime[i] >= Configs[i].TimeUntilLosingSight) {
+			bSensed[i] = false;
+			events.Emplace(Controllers[i].Get(), false);
+		}
+	}
+
+	for (const TPair<AEnemyAIController*, bool>& event : events)
+		event.Key->HandleTargetPerception(player, event.Value);
+}
+
+
+void UEnemyPerceptionSubsystem::RegisterListener(AEnemyAIController* Controller, const FEnemySightConfig& Config) {
+
+	if (!Controller || Controllers.Contains(Controller)) return;
+
+	const uint32 id = NextListenerId++;
+	IdToIndex.Add(id, Controllers.Num());
+
+	Controllers.Add(Controller);
+	ListenerIds.Add(id);
+	Configs.Add(Config);
+	bInCone.Add(false);
+	bTraceVisible.Add(false);
+	bTracePending.Add(false);
+	bDiscardTrace.Add(false);
+	LastTraceTime.Add(0.0);
+	bVisible.Add(false);
+	LastVisibleChangeTime.Add(0.0);
+	bSensed.Add(false);
+	LastSeenTime.Add(0.0);
+}
+
+
+void UEnemyPerceptionSubsystem::UnregisterListener(AEnemyAIController* Controller) {
+
+	int32 index = Controllers.IndexOfByKey(Controller);
+	if (index != INDEX_NONE)
+		RemoveListenerAtSwap(index);
+}
+
+
+// Removes a listener by moving the last one into its place, traces in flight for it are ignored
+void UEnemyPerceptionSubsystem::RemoveListenerAtSwap(int32 Index) {
+
+	IdToIndex.Remove(ListenerIds[Index]);
+
+	const int32 lastIndex = Controllers.Num() - 1;
+	if (Index != lastIndex)
+		IdToIndex[ListenerIds[lastIndex]] = Index;
+
+	Controllers.RemoveAtSwap(Index, EAllowShrinking::No);
+	ListenerIds.RemoveAtSwap(Index, EAllowShrinking::No);
+	Configs.RemoveAtSwap(Index, EAllowShrinking::No);
+	bInCone.RemoveAtSwap(Index, EAllowShrinking::No);
+	bTraceVisible.RemoveAtSwap(Index, EAllowShrinking::No);
+	bTracePending.RemoveAtSwap(Index, EAllowShrinking::No);
+	bDiscardTrace.RemoveAtSwap(Index, EAllowShrinking::No);
+	LastTraceTime.RemoveAtSwap(Index, EAllowShrinking::No);
+	bVisible.RemoveAtSwap(Index, EAllowShrinking::No);
+	LastVisibleChangeTime.RemoveAtSwap(Index, EAllowShrinking::No);
+	bSensed.RemoveAtSwap(Index, EAllowShrinking::No);
+	LastSeenTime.RemoveAtSwap(Index, EAllowShrinking::No);
+}
+
+
+// Copies each listener's eye location, view direction and current radius into packed arrays (padded to a multiple of 4)
+void UEnemyPerceptionSubsystem::GatherListenerViews(const FVector& PlayerLocation) {
+
+	const int32 numListeners = Controllers.Num();
+	const int32 paddedNum = Align(numListeners, 4);
+
+	for (TArray<float>* packed : { &EyeX, &EyeY, &EyeZ, &ForwardX, &ForwardY, &ForwardZ, &RadiusSqr, &CosHalfAngle })
+		packed->SetNumUninitialized(paddedNum, EAllowShrinking::No);
+
+	for (int32 i = 0; i < numListeners; i++) {
+
+		FVector eyeLocation;
+		FRotator eyeRotation;
+		Controllers[i]->GetActorEyesViewPoint(eyeLocation, eyeRotation);
+		const FVector forward = eyeRotation.Vector();
+		const FEnemySightConfig& config = Configs[i];
+
+		EyeX[i] = eyeLocation.X;
+		EyeY[i] = eyeLocation.Y;
+		EyeZ[i] = eyeLocation.Z;
+		ForwardX[i] = forward.X;
+		ForwardY[i] = forward.Y;
+		ForwardZ[i] = forward.Z;
+
+		// Like the sight sense, a visible player is kept until it leaves the lose sight radius
+		RadiusSqr[i] = FMath::Square(bVisible[i] ? config.LoseSightRadius : config.SightRadius);
+		CosHalfAngle[i] = FMath::Cos(FMath::DegreesToRadians(config.PeripheralVisionAngleDegrees));
+	}
+
+	// *** Padding Never Passes the Radius Test
+	for (int32 i = numListeners; i < paddedNum; i++) {
+		EyeX[i] = EyeY[i] = EyeZ[i] = 0.0f;
+		ForwardX[i] = ForwardY[i] = ForwardZ[i] = 0.0f;
+		RadiusSqr[i] = -1.0f;
+		CosHalfAngle[i] = 1.0f;
+	}
+}
+
+
+// Radius and view cone test for 4 listeners at a time
+void UEnemyPerceptionSubsystem::RunPrefilter(const FVector& PlayerLocation) {
+
+	const VectorRegister4Float playerX = VectorSetFloat1((float)PlayerLocation.X);
+	const VectorRegister4Float playerY = VectorSetFloat1((float)PlayerLocation.Y);
+	const VectorRegister4Float playerZ = VectorSetFloat1((float)PlayerLocation.Z);
+	const int32 numListeners = Controllers.Num();
+	int32 numInCone = 0;
+
+	for (int32 i = 0; i < numListeners; i += 4) {
+
+		const VectorRegister4Float dx = VectorSubtract(playerX, VectorLoad(EyeX.GetData() + i));
+		const VectorRegister4Float dy = VectorSubtract(playerY, VectorLoad(EyeY.GetData() + i));
+		const VectorRegister4Float dz = VectorSubtract(playerZ, VectorLoad(EyeZ.GetData() + i));
+
+		VectorRegister4Float distSqr = VectorMultiply(dx, dx);
+		distSqr = VectorMultiplyAdd(dy, dy, distSqr);
+		distSqr = VectorMultiplyAdd(dz, dz, distSqr);
+
+		VectorRegister4Float dot = VectorMultiply(dx, VectorLoad(ForwardX.GetData() + i));
+		dot = VectorMultiplyAdd(dy, VectorLoad(ForwardY.GetData() + i), dot);
+		dot = VectorMultiplyAdd(dz, VectorLoad(ForwardZ.GetData() + i), dot);
+
+		// In range: distSqr <= radiusSqr, in cone: dot >= cos(half angle) * distance
+		const VectorRegister4Float inRange = VectorCompareLE(distSqr, VectorLoad(RadiusSqr.GetData() + i));
+		const VectorRegister4Float minDot = VectorMultiply(VectorLoad(CosHalfAngle.GetData() + i), VectorSqrt(distSqr));
+		const int32 mask = VectorMaskBits(VectorBitwiseAnd(inRange, VectorCompareGE(dot, minDot)));
+
+		for (int32 lane = 0; lane < 4 && i + lane < numListeners; lane++) {
+			const int32 index = i + lane;
+			const bool bNowInCone = (mask & (1 << lane)) != 0;
+
+			// Leaving the cone forgets the last trace, so sight after re-entering needs a fresh one
+			if (bInCone[index] && !bNowInCone) {
+				bTraceVisible[index] = false;
+				bDiscardTrace[index] = bTracePending[index];
+			}
+
+			bInCone[index] = bNowInCone;
+			numInCone += bNowInCone;
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_LockOnPerceptionInCone, numInCone);
+}
+
+
+// Starts async traces for listeners in the cone, the ones traced longest ago first
+void UEnemyPerceptionSubsystem::IssueSightTraces(AActor* Player) {
+
+	TArray<int32, TInlineAllocator<64>> candidates;
+	for (int32 i = 0; i < Controllers.Num(); i++) {
+		if (bInCone[i] && !bTracePending[i])
+			candidates.Add(i);
+	}
+
+	candidates.Sort([this](int32 A, int32 B) { return LastTraceTime[A] < LastTraceTime[B]; });
+
+	const int32 numTraces = FMath::Min(candidates.Num(), CVarSightTracesPerFrame.GetValueOnGameThread());
+	const FVector target = Player->GetActorLocation();
+	const double now = GetWorld()->GetTimeSeconds();
+
+	for (int32 t = 0; t < numTraces; t++) {
+		const int32 index = candidates[t];
+
+		FCollisionQueryParams params(SCENE_QUERY_STAT(EnemySharedSight), true);
+		params.AddIgnoredActor(Controllers[index]->GetPawn());
+		params.AddIgnoredActor(Player);
+
+		GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, FVector(EyeX[index], EyeY[index], EyeZ[index]), target,
+			ECC_Visibility, params, FCollisionResponseParams::DefaultResponseParam, &SightTraceDelegate, ListenerIds[index]);
+
+		bTracePending[index] = true;
+		LastTraceTime[index] = now;
+	}
+
+	INC_DWORD_STAT_BY(STAT_LockOnPerceptionTraces, numTraces);
+	CSV_CUSTOM_STAT(EnemyAI, SightTraces, numTraces, ECsvCustomStatOp::Set);
+}
+
+
+// Async trace results arrive next frame, anything blocking the trace blocks sight
+void UEnemyPerceptionSubsystem::OnSightTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum) {
+
+	const int32* index = IdToIndex.Find(Datum.UserData);
+	if (!index) return;			// Listener was removed while the trace was in flight
+
+	bTracePending[*index] = false;
+	if (bDiscardTrace[*index]) {		// Issued before the listener left the cone
+		bDiscardTrace[*index] = false;
+		return;
+	}
+
+	bTraceVisible[*index] = !(Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit);
+}
+
+
+void UEnemyPerceptionSubsystem::ValidateComponentEvent(AEnemyAIController* Controller, bool bComponentSensed) {
+
+	int32 index = Controllers.IndexOfByKey(Controller);
+	if (index == INDEX_NONE) return;
+
+	const double now = GetWorld()->GetTimeSeconds();
+	if (bVisible[index] == bComponentSensed || now - LastVisibleChangeTime[index] <= SightValidationTolerance) {
+		NumValidationMatches++;
+		INC_DWORD_STAT(STAT_LockOnPerceptionValidationMatches);
+		return;
+	}
+
+	NumValidationMismatches++;
+	INC_DWORD_STAT(STAT_LockOnPerceptionValidationMismatches);
+	UE_LOG(LogTemp, Warning, TEXT("Shared perception mismatch on %s: component %s, shared %s (%d of %d events mismatched)"),
+		*Controller->GetName(), bComponentSensed ? TEXT("sensed") : TEXT("lost"), bVisible[index] ? TEXT("visible") : TEXT("not visible"),
+		NumValidationMismatches, NumValidationMatches + NumValidationMismatches);
+}
@@ -0,0 +1,150 @@
+/*
+* Author: Eyan Martucci
+* Description: Keeps dead and despawned enemies hidden in a pool and reuses them for new spawns,
+*	so spawning skips actor construction, component registration, AI possession and widget creation.
+*	Spawn times go into histograms, compare LockOn.UseEnemyPool 0 and 1 with LockOn.DumpEnemySpawnHistograms.
+*/
+
+#include "Subsystems/EnemyPoolSubsystem.h"
+
+#include "Characters/EnemyCharacter.h"			// For AEnemyCharacter
+#include "HAL/IConsoleManager.h"				// For console variables and commands
+#include "LockOnTargetingStats.h"				// For pool stats
+
+
+static TAutoConsoleVariable<bool> CVarUseEnemyPool(
+	TEXT("LockOn.UseEnemyPool"), true,
+	TEXT("If true, dead and despawned enemies are hidden and reused instead of destroyed and spawned again."));
+
+static TAutoConsoleVariable<int32> CVarEnemyPoolMaxSize(
+	TEXT("LockOn.EnemyPoolMaxSize"), 512,
+	TEXT("Released enemies are destroyed instead of pooled once this many are waiting in the pool."));
+
+static FAutoConsoleCommandWithWorldAndArgs DumpEnemySpawnHistogramsCommand(
+	TEXT("LockOn.DumpEnemySpawnHistograms"),
+	TEXT("Logs enemy spawn time histograms for new actors and pooled reuse. Usage: LockOn.DumpEnemySpawnHistograms [reset]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+
+		UEnemyPoolSubsystem* pool = World ? World->GetSubsystem<UEnemyPoolSubsystem>() : nullptr;
+		if (!pool) return;
+
+		pool->DumpHistograms();
+		if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+			pool->ResetHistograms();
+	}));
+
+
+void UEnemyPoolSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	ResetHistograms();
+}
+
+
+bool UEnemyPoolSubsystem::IsEnabled() {
+	return CVarUseEnemyPool.GetValueOnGameThread();
+}
+
+
+void UEnemyPoolSubsystem::Prewarm(TSubclassOf<AEnemyCharacter> EnemyClass, int32 Count, const FVector& Location) {
+
+	if (!IsEnabled() || !EnemyClass) return;
+
+	const double startTime = FPlatformTime::Seconds();
+	int32 numSpawned = 0;
+
+	for (int32 i = 0; i < Count; i++) {
+		AEnemyCharacter* enemy = SpawnNewEnemy(EnemyClass, Location, FRotator::ZeroRotator,
+			ESpawnActorCollisionHandlingMethod::AlwaysSpawn);		// All prewarmed enemies share one location
+		if (!enemy) continue;
+
+		ReleaseEnemy(enemy);
+		numSpawned++;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Enemy pool prewarmed %d enemies in %.2fms"),
+		numSpawned, (FPlatformTime::Seconds() - startTime) * 1000.0);
+}
+
+
+AEnemyCharacter* UEnemyPoolSubsystem::AcquireEnemy(TSubclassOf<AEnemyCharacter> EnemyClass, const FVector& Location, const FRotator& Rotation) {
+
+	if (!EnemyClass) return nullptr;
+
+	LOCKON_SCOPED_TIMER(STAT_LockOnEnemySpawn, EnemyAI, EnemySpawn);
+	const double startTime = FPlatformTime::Seconds();
+
+	// *** Reuse a Pooled Enemy of the Same Class
+	AEnemyCharacter* enemy = nullptr;
+
+	for (int32 i = FreeEnemies.Num() - 1; i >= 0; i--) {
+
+		if (!IsValid(FreeEnemies[i])) {
+			FreeEnemies.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		if (FreeEnemies[i]->GetClass() == EnemyClass.Get()) {
+			enemy = FreeEnemies[i];
+			FreeEnemies.RemoveAtSwap(i, EAllowShrinking::No);
+			break;
+		}
+	}
+
+	if (enemy) {
+		enemy->OnAcquiredFromPool(Location, Rotation);
+		PooledHistogram.AddMeasurement((FPlatformTime::Seconds() - startTime) * 1000.0);
+		INC_DWORD_STAT(STAT_LockOnEnemyPoolHits);
+	}
+
+	// *** Otherwise Spawn a New One
+	else {
+		enemy = SpawnNewEnemy(EnemyClass, Location, Rotation);
+		SpawnActorHistogram.AddMeasurement((FPlatformTime::Seconds() - startTime) * 1000.0);
+		INC_DWORD_STAT(STAT_LockOnEnemyPoolMisses);
+	}
+
+	SET_DWORD_STAT(STAT_LockOnEnemyPoolFree, FreeEnemies.Num());
+	CSV_CUSTOM_STAT(EnemyAI, EnemySpawnMs, (FPlatformTime::Seconds() - startTime) * 1000.0, ECsvCustomStatOp::Max);
+	return enemy;
+}
+
+
+void UEnemyPoolSubsystem::ReleaseEnemy(AEnemyCharacter* Enemy) {
+
+	if (!IsValid(Enemy) || Enemy->IsInPool()) return;
+
+	if (!IsEnabled() || FreeEnemies.Num() >= CVarEnemyPoolMaxSize.GetValueOnGameThread()) {
+		Enemy->Destroy();
+		return;
+	}
+
+	Enemy->OnReleasedToPool();
+	FreeEnemies.Add(Enemy);
+	SET_DWORD_STAT(STAT_LockOnEnemyPoolFree, FreeEnemies.Num());
+}
+
+
+void UEnemyPoolSubsystem::ResetHistograms() {
+
+	// Bin edges in ms, small enough to separate pooled reuse from a full spawn and wide enough to show hitches
+	static const double thresholdsMs[] = { 0.0, 0.05, 0.1, 0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.0, 33.3 };
+	SpawnActorHistogram.InitFromArray(thresholdsMs);
+	PooledHistogram.InitFromArray(thresholdsMs);
+}
+
+
+void UEnemyPoolSubsystem::DumpHistograms() {
+
+	SpawnActorHistogram.DumpToLog(TEXT("Enemy Spawn (SpawnActor) ms"));
+	PooledHistogram.DumpToLog(TEXT("Enemy Spawn (Pooled) ms"));
+}
+
+
+AEnemyCharacter* UEnemyPoolSubsystem::SpawnNewEnemy(TSubclassOf<AEnemyCharacter> EnemyClass, const FVector& Location,
+	const FRotator& Rotation, ESpawnActorCollisionHandlingMethod CollisionHandling) const {
+
+	FActorSpawnParameters spawnParams;
+	spawnParams.SpawnCollisionHandlingOverride = CollisionHandling;
+	return GetWorld()->SpawnActor<AEnemyCharacter>(EnemyClass, Location, Rotation, spawnParams);
+}
@@ -0,0 +1,242 @@
+/*
+* Author: Eyan Martucci
+* Description: Swaps enemies between full AEnemyCharacter actors near the player and lightweight
+*	Mass entities (see UEnemyProxyProcessor) further away. Promotion and demotion use two radii
+*	so enemies at the edge don't swap back and forth, and are limited per update to avoid spawn hitches.
+*/
+
+#include "Subsystems/EnemyProxySubsystem.h"
+
+#include "Mass/EnemyProxyFragments.h"			// For FEnemyProxyFragment
+#include "MassEntitySubsystem.h"				// For UMassEntitySubsystem
+#include "MassEntityManager.h"					// For FMassEntityManager
+#include "MassCommonFragments.h"				// For FTransformFragment
+#include "MassMovementFragments.h"				// For FMassVelocityFragment
+#include "Characters/EnemyCharacter.h"			// For AEnemyCharacter
+#include "Characters/PlayerCharacter.h"			// For SpawnEnemyAtLocation
+#include "Components/EnemyHealth.h"				// For carrying health across swaps
+#include "NavigationSystem.h"					// For ProjectPointToNavigation
+#include "Kismet/GameplayStatics.h"				// For GetPlayerCharacter
+#include "HAL/IConsoleManager.h"				// For console variables and commands
+#include "LockOnTargetingStats.h"				// For proxy stats
+
+
+static TAutoConsoleVariable<bool> CVarUseEnemyProxies(
+	TEXT("LockOn.UseEnemyProxies"), true,
+	TEXT("If true, roaming enemies far from the player are demoted to Mass entities and promoted back when close."));
+
+static TAutoConsoleVariable<float> CVarEnemyProxyPromoteRadius(
+	TEXT("LockOn.EnemyProxyPromoteRadius"), 5000.0f,
+	TEXT("Proxies closer than this to the player (2D) become enemy actors."));
+
+static TAutoConsoleVariable<float> CVarEnemyProxyDemoteRadius(
+	TEXT("LockOn.EnemyProxyDemoteRadius"), 6000.0f,
+	TEXT("Roaming enemy actors further than this from the player (2D) become proxies. Must be greater than the promote radius,\n")
+	TEXT("smaller values are raised to it so enemies at the edge don't swap back and forth."));
+
+static TAutoConsoleVariable<float> CVarEnemyProxyUpdateInterval(
+	TEXT("LockOn.EnemyProxyUpdateInterval"), 0.2f,
+	TEXT("Seconds between promotion and demotion passes."));
+
+static TAutoConsoleVariable<int32> CVarEnemyProxyMaxSwaps(
+	TEXT("LockOn.EnemyProxyMaxSwaps"), 8,
+	TEXT("Promotions and demotions are each limited to this many per update, to avoid spawn hitches."));
+
+static FAutoConsoleCommandWithWorldAndArgs SpawnEnemyProxiesCommand(
+	TEXT("LockOn.SpawnEnemyProxies"),
+	TEXT("Spawns background enemies around the player. Usage: LockOn.SpawnEnemyProxies [Count] [Radius]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+
+		UEnemyProxySubsystem* proxies = World ? World->GetSubsystem<UEnemyProxySubsystem>() : nullptr;
+		APawn* player = UGameplayStatics::GetPlayerPawn(World, 0);
+		if (!proxies || !player) return;
+
+		int32 count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000;
+		float radius = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 30000.0f;
+		proxies->SpawnProxies(count, player->GetActorLocation(), radius);
+	}));
+
+
+TStatId UEnemyProxySubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyProxySubsystem, STATGROUP_Tickables);
+}
+
+
+bool UEnemyProxySubsystem::IsEnabled() {
+	return CVarUseEnemyProxies.GetValueOnGameThread();
+}
+
+
+// Promotes and demotes a limited number of enemies every update interval
+void UEnemyProxySubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	UpdateTimer -= DeltaTime;
+	if (UpdateTimer > 0.0f) return;
+	UpdateTimer = FMath::Max(CVarEnemyProxyUpdateInterval.GetValueOnGameThread(), 0.0f);
+
+	LOCKON_SCOPED_TIMER(STAT_LockOnEnemyProxySwaps, EnemyAI, EnemyProxySwaps);
+
+	FMassEntityManager* entityManager = GetEntityManager();
+	APawn* player = UGameplayStatics::GetPlayerPawn(this, 0);
+	if (!entityManager || !player) return;
+
+	// *** Keep the Demote Radius Outside the Promote Radius
+	const float promoteRadius = FMath::Max(CVarEnemyProxyPromoteRadius.GetValueOnGameThread(), 0.0f);
+	float demoteRadius = CVarEnemyProxyDemoteRadius.GetValueOnGameThread();
+	if (demoteRadius <= promoteRadius) {
+		static bool bWarnedRadii = false;
+		if (!bWarnedRadii) {
+			UE_LOG(LogTemp, Warning, TEXT("LockOn.EnemyProxyDemoteRadius (%.0f) must be greater than LockOn.EnemyProxyPromoteRadius (%.0f), using %.0f"),
+				demoteRadius, promoteRadius, promoteRadius + 500.0f);
+			bWarnedRadii = true;
+		}
+		demoteRadius = promoteRadius + 500.0f;
+	}
+
+	const int32 maxSwaps = FMath::Max(CVarEnemyProxyMaxSwaps.GetValueOnGameThread(), 0);
+
+	PromoteNearbyProxies(*entityManager, player->GetActorLocation(), promoteRadius, maxSwaps);
+
+	if (IsEnabled() && !bDemotionPaused)
+		DemoteDistantEnemies(*entityManager, player->GetActorLocation(), demoteRadius, maxSwaps);
+
+	SET_DWORD_STAT(STAT_LockOnEnemyProxies, ProxyHandles.Num());
+	CSV_CUSTOM_STAT(EnemyAI, EnemyProxies, ProxyHandles.Num(), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(EnemyAI, EnemyActors, ActiveEnemies.Num(), ECsvCustomStatOp::Set);
+}
+
+
+void UEnemyProxySubsystem::RegisterEnemy(AEnemyCharacter* Enemy) {
+	ActiveEnemies.AddUnique(Enemy);
+}
+
+
+void UEnemyProxySubsystem::UnregisterEnemy(AEnemyCharacter* Enemy) {
+	ActiveEnemies.RemoveSwap(Enemy, EAllowShrinking::No);
+}
+
+
+void UEnemyProxySubsystem::SpawnProxies(int32 Count, const FVector& Center, float Radius) {
+
+	FMassEntityManager* entityManager = GetEntityManager();
+	if (!entityManager || Count <= 0 || !EnsureArchetype()) return;
+
+	for (int32 i = 0; i < Count; i++) {
+		const float angle = ProxyStream.FRandRange(0.0f, UE_TWO_PI);
+		const float distance = Radius * FMath::Sqrt(ProxyStream.FRand());		// Uniform over the circle
+		const FVector location = Center + FVector(FMath::Cos(angle) * distance, FMath::Sin(angle) * distance, 0.0f);
+
+		ProxyHandles.Add(CreateProxy(*entityManager, location, FRotator(0.0f, FMath::RadiansToDegrees(angle), 0.0f), -1.0f, ProxyStream.FRandRange(0.0f, 3.0f)));
+	}
+}
+
+
+FMassEntityManager* UEnemyProxySubsystem::GetEntityManager() const {
+
+	UMassEntitySubsystem* entitySubsystem = GetWorld()->GetSubsystem<UMassEntitySubsystem>();
+	return entitySubsystem ? &entitySubsystem->GetMutableEntityManager() : nullptr;
+}
+
+
+bool UEnemyProxySubsystem::EnsureArchetype() {
+
+	if (ProxyArchetype.IsValid()) return true;
+
+	FMassEntityManager* entityManager = GetEntityManager();
+	if (!entityManager) return false;
+
+	ProxyArchetype = entityManager->CreateArchetype({ FTransformFragment::StaticStruct(), FMassVelocityFragment::StaticStruct(),
+		FEnemyProxyFragment::StaticStruct(), FEnemyProxyTag::StaticStruct() });
+	return ProxyArchetype.IsValid();
+}
+
+
+// Health below zero means full health
+FMassEntityHandle UEnemyProxySubsystem::CreateProxy(FMassEntityManager& EntityManager, const FVector& Location,
+	const FRotator& Rotation, float Health, float IdleTime) {
+
+	FMassEntityHandle entity = EntityManager.CreateEntity(ProxyArchetype);
+
+	EntityManager.GetFragmentDataChecked<FTransformFragment>(entity).SetTransform(FTransform(Rotation, Location));
+
+	FEnemyProxyFragment& proxy = EntityManager.GetFragmentDataChecked<FEnemyProxyFragment>(entity);
+	proxy.State = EEnemyState::RoamIdle;
+	proxy.StateTimer = IdleTime;
+	proxy.Health = Health;
+	proxy.HomeLocation = Location;
+	proxy.RandomStream.Initialize(ProxyStream.GetUnsignedInt());
+
+	return entity;
+}
+
+
+// Spawns actors for proxies inside the promote radius, on the navmesh and with their health and facing
+void UEnemyProxySubsystem::PromoteNearbyProxies(FMassEntityManager& EntityManager, const FVector& PlayerLocation, float PromoteRadius, int32 MaxSwaps) {
+
+	APlayerCharacter* player = Cast<APlayerCharacter>(UGameplayStatics::GetPlayerCharacter(this, 0));
+	UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!player) return;
+
+	int32 numPromoted = 0;
+
+	for (int32 i = ProxyHandles.Num() - 1; i >= 0 && numPromoted < MaxSwaps; i--) {
+
+		const FMassEntityHandle entity = ProxyHandles[i];
+		if (!EntityManager.IsEntityValid(entity)) {
+			ProxyHandles.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		const FTransform& transform = EntityManager.GetFragmentDataChecked<FTransformFragment>(entity).GetTransform();
+		if (FVector::DistSquared2D(transform.GetLocation(), PlayerLocation) > FMath::Square(PromoteRadius)) continue;
+
+		// *** Place on the Navmesh (proxies roam without it)
+		FVector spawnLocation = transform.GetLocation();
+		FNavLocation projected;
+		if (navSystem && navSystem->ProjectPointToNavigation(spawnLocation, projected, FVector(200.0f, 200.0f, 2000.0f)))
+			spawnLocation = projected.Location;
+
+		AEnemyCharacter* enemy = player->SpawnEnemyAtLocation(spawnLocation + FVector(0.0f, 0.0f, 100.0f));
+		if (!enemy) continue;
+
+		enemy->SetActorRotation(FRotator(0.0f, transform.Rotator().Yaw, 0.0f));
+
+		const FEnemyProxyFragment& proxy = EntityManager.GetFragmentDataChecked<FEnemyProxyFragment>(entity);
+		if (proxy.Health >= 0.0f)
+			enemy->GetHealthComponent()->SetHealth(proxy.Health);
+
+		EntityManager.DestroyEntity(entity);
+		ProxyHandles.RemoveAtSwap(i, EAllowShrinking::No);
+		numPromoted++;
+	}
+
+	INC_DWORD_STAT_BY(STAT_LockOnEnemyProxyPromotions, numPromoted);
+}
+
+
+// Turns roaming actors outside the demote radius back into proxies
+void UEnemyProxySubsystem::DemoteDistantEnemies(FMassEntityManager& EntityManager, const FVector& PlayerLocation, float DemoteRadius, int32 MaxSwaps) {
+
+	if (!EnsureArchetype()) return;
+
+	int32 numDemoted = 0;
+
+	for (int32 i = ActiveEnemies.Num() - 1; i >= 0 && numDemoted < MaxSwaps; i--) {
+
+		AEnemyCharacter* enemy = ActiveEnemies[i];
+		if (!IsValid(enemy) || enemy->GetIsInCombat()) continue;
+
+		const UEnemyHealth* health = enemy->GetHealthComponent();
+		if (!health || health->GetHealth() <= 0.0f) continue;		// Let the death montage finish
+		if (FVector::DistSquared2D(enemy->GetActorLocation(), PlayerLocation) <= FMath::Square(DemoteRadius)) continue;
+
+		const float proxyHealth = health->GetHealth() < health->GetMaxHealth() ? health->GetHealth() : -1.0f;
+		ProxyHandles.Add(CreateProxy(EntityManager, enemy->GetActorLocation(), enemy->GetActorRotation(), proxyHealth, 0.0f));
+
+		enemy->Despawn();		// Unregisters itself before going into the enemy pool
+		numDemoted++;
+	}
+
+	INC_DWORD_STAT_BY(STAT_LockOnEnemyProxyDemotions, numDemoted);
+}
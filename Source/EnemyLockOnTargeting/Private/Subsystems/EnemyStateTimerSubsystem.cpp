@@ -0,0 +1,120 @@
+/*
+* Author: Eyan Martucci
+* Description: Shared timer wheel for enemy state transitions. Idle and retreat countdowns are
+*	scheduled here instead of ticking every controller, expired timers are fired in one batch.
+*/
+
+#include "Subsystems/EnemyStateTimerSubsystem.h"
+
+#include "HAL/IConsoleManager.h"		// For console variables and commands
+#include "LockOnTargetingStats.h"		// For timer wheel stats
+
+
+static TAutoConsoleVariable<int32> CVarEnemyStateTimerMode(
+	TEXT("LockOn.EnemyStateTimerMode"), (int32)EEnemyStateTimerMode::TimerWheel,
+	TEXT("How enemy idle and retreat timers are counted down. 0: per actor tick, 1: world timer manager, 2: shared timer wheel,\n")
+	TEXT("3: packed decision array (LockOn.UseEnemyDecisionArray).\n")
+	TEXT("Applies to timers started after the change, compare modes with LockOn.RunBenchmark."));
+
+
+TStatId UEnemyStateTimerSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyStateTimerSubsystem, STATGROUP_Tickables);
+}
+
+
+EEnemyStateTimerMode UEnemyStateTimerSubsystem::GetTimerMode() {
+	return (EEnemyStateTimerMode)FMath::Clamp(CVarEnemyStateTimerMode.GetValueOnGameThread(), 0, 3);
+}
+
+
+// Advances the wheel and switches the state of every controller whose timer expired
+void UEnemyStateTimerSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+	LOCKON_SCOPED_TIMER(STAT_LockOnStateTimerWheel, EnemyAI, StateTimerWheel);
+
+	ExpiredTimers.Reset();
+	TimerWheel.Advance(DeltaTime, ExpiredTimers);
+
+	// *** Fire the Expired Batch (callbacks may schedule new timers)
+	for (const FEnemyStateTimer& timer : ExpiredTimers) {
+		if (AEnemyAIController* controller = timer.Controller.Get())
+			controller->OnStateTimerExpired(timer.NextState);
+	}
+
+	INC_DWORD_STAT_BY(STAT_LockOnStateTimersFired, ExpiredTimers.Num());
+	SET_DWORD_STAT(STAT_LockOnStateTimersPending, TimerWheel.GetNumActive());
+	CSV_CUSTOM_STAT(EnemyAI, StateTimersFired, ExpiredTimers.Num(), ECsvCustomStatOp::Set);
+}
+
+
+FTimerWheelHandle UEnemyStateTimerSubsystem::ScheduleStateTimer(AEnemyAIController* Controller, float Delay, EEnemyState NextState) {
+	return TimerWheel.Schedule(Delay, FEnemyStateTimer{ Controller, NextState });
+}
+
+
+void UEnemyStateTimerSubsystem::CancelStateTimer(FTimerWheelHandle& Handle) {
+	TimerWheel.Cancel(Handle);
+}
+
+
+// *** Microbenchmark: LockOn.BenchStateTimers [NumTimers] [NumFrames]
+//	Simulates idle enemies that restart a 1-3 second timer whenever it expires, at 60 fps.
+//	Compares a per timer countdown loop (the cost floor of per actor ticking, before tick dispatch overhead)
+//	with the timer wheel. FTimerManager can only tick once per engine frame, so it is compared in game by
+//	running LockOn.RunBenchmark with each LockOn.EnemyStateTimerMode.
+static FAutoConsoleCommand BenchStateTimersCommand(
+	TEXT("LockOn.BenchStateTimers"),
+	TEXT("Compares per timer countdowns with the timer wheel. Usage: LockOn.BenchStateTimers [NumTimers] [NumFrames]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+
+		const int32 numTimers = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10000;
+		const int32 numFrames = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 3600;
+		const float deltaTime = 1.0f / 60.0f;
+
+		// *** Per Timer Countdown
+		FRandomStream countdownStream(1337);
+		TArray<float> countdowns;
+		countdowns.SetNumUninitialized(numTimers);
+		for (float& countdown : countdowns)
+			countdown = countdownStream.FRandRange(1.0f, 3.0f);
+
+		int64 countdownFired = 0;
+		const double countdownStart = FPlatformTime::Seconds();
+
+		for (int32 frame = 0; frame < numFrames; frame++) {
+			for (float& countdown : countdowns) {
+				countdown -= deltaTime;
+				if (countdown <= 0.0f) {
+					countdown = countdownStream.FRandRange(1.0f, 3.0f);
+					countdownFired++;
+				}
+			}
+		}
+		const double countdownMs = (FPlatformTime::Seconds() - countdownStart) * 1000.0;
+
+		// *** Timer Wheel
+		FRandomStream wheelStream(1337);
+		TTimerWheel<int32> wheel;
+		for (int32 i = 0; i < numTimers; i++)
+			wheel.Schedule(wheelStream.FRandRange(1.0f, 3.0f), i);
+
+		TArray<int32> expired;
+		int64 wheelFired = 0;
+		const double wheelStart = FPlatformTime::Seconds();
+
+		for (int32 frame = 0; frame < numFrames; frame++) {
+			expired.Reset();
+			wheel.Advance(deltaTime, expired);
+
+			for (int32 id : expired)
+				wheel.Schedule(wheelStream.FRandRange(1.0f, 3.0f), id);
+			wheelFired += expired.Num();
+		}
+		const double wheelMs = (FPlatformTime::Seconds() - wheelStart) * 1000.0;
+
+		UE_LOG(LogTemp, Display, TEXT("State timer benchmark: %d timers, %d frames"), numTimers, numFrames);
+		UE_LOG(LogTemp, Display, TEXT("  Countdown:   %.3f ms total, %.4f ms/frame, %lld fired"),
+			countdownMs, countdownMs / numFrames, countdownFired);
+		UE_LOG(LogTemp, Display, TEXT("  Timer wheel: %.3f ms total, %.4f ms/frame, %lld fired"),
+			wheelMs, wheelMs / numFrames, wheelFired);
+	}));
@@ -0,0 +1,105 @@
+/*
+* Author: Eyan Martucci
+* Description: Uses the significance manager to bucket enemies by distance to the player camera
+*	and whether they are on screen, then lowers the tick rate of far or hidden enemies.
+*/
+
+#include "Subsystems/EnemyTickLODSubsystem.h"
+
+#include "SignificanceManager.h"				// For USignificanceManager
+#include "Characters/EnemyCharacter.h"			// For AEnemyCharacter
+#include "Kismet/GameplayStatics.h"				// For GetPlayerCameraManager
+#include "Camera/PlayerCameraManager.h"			// For camera location and FOV
+
+static const FName EnemySignificanceTag(TEXT("Enemy"));
+
+
+TStatId UEnemyTickLODSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyTickLODSubsystem, STATGROUP_Tickables);
+}
+
+
+// Updates enemy significance from the player camera viewpoint
+void UEnemyTickLODSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	USignificanceManager* significanceManager = FSignificanceManagerModule::Get(GetWorld());
+	APlayerCameraManager* camManager = UGameplayStatics::GetPlayerCameraManager(this, 0);
+	if (!significanceManager || !camManager) return;
+
+	// *** Store Viewpoint Used by the Significance Function
+	Viewpoint = FTransform(camManager->GetCameraRotation(), camManager->GetCameraLocation());
+	CosHalfFOV = FMath::Cos(FMath::DegreesToRadians(camManager->GetFOVAngle() * 0.5f));
+
+	TArray<FTransform> viewpoints;
+	viewpoints.Add(Viewpoint);
+	significanceManager->Update(viewpoints);
+}
+
+
+// Registers an enemy with the significance manager, its tick rate changes when its LOD changes
+void UEnemyTickLODSubsystem::RegisterEnemy(AEnemyCharacter* Enemy) {
+
+	USignificanceManager* significanceManager = FSignificanceManagerModule::Get(GetWorld());
+	if (!significanceManager || !Enemy) return;
+
+	significanceManager->RegisterObject(Enemy, EnemySignificanceTag,
+		[this](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& InViewpoint) {
+			return CalculateSignificance(ObjectInfo->GetObject(), InViewpoint);
+		},
+		USignificanceManager::EPostSignificanceType::Sequential,
+		[this](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float NewSignificance, bool bFinal) {
+			if (OldSignificance == NewSignificance) return;
+
+			if (AEnemyCharacter* enemy = Cast<AEnemyCharacter>(ObjectInfo->GetObject()))
+				enemy->SetTickLOD((EEnemyTickLOD)FMath::RoundToInt32(NewSignificance));
+		});
+
+	// The callback above skips unchanged significance, including the first one from RegisterObject, so apply the
+	//	registered LOD here (new enemies start at interval 0, pooled ones keep the interval from before release)
+	Enemy->SetTickLOD((EEnemyTickLOD)FMath::RoundToInt32(significanceManager->GetSignificance(Enemy)));
+}
+
+
+// Stops managing an enemy
+void UEnemyTickLODSubsystem::UnregisterEnemy(AEnemyCharacter* Enemy) {
+
+	if (USignificanceManager* significanceManager = FSignificanceManagerModule::Get(GetWorld()))
+		significanceManager->UnregisterObject(Enemy);
+}
+
+
+// Returns the tick interval for an LOD bucket (0 means every frame)
+float UEnemyTickLODSubsystem::GetTickInterval(EEnemyTickLOD LOD) const {
+
+	switch (LOD) {
+		case EEnemyTickLOD::Medium:	return MediumTickInterval;
+		case EEnemyTickLOD::Low:	return LowTickInterval;
+		default:					return 0.0f;
+	}
+}
+
+
+// Buckets an enemy by distance to the camera, off screen enemies drop one bucket
+float UEnemyTickLODSubsystem::CalculateSignificance(const UObject* Object, const FTransform& InViewpoint) const {
+
+	const AActor* actor = Cast<AActor>(Object);
+	if (!actor) return (float)EEnemyTickLOD::Low;
+
+	FVector toEnemy = actor->GetActorLocation() - InViewpoint.GetLocation();
+	float distance = toEnemy.Size();
+
+	if (distance < AlwaysHighDistance)
+		return (float)EEnemyTickLOD::High;
+
+	// *** Bucket by Distance
+	int32 lod = distance < HighLODDistance ? (int32)EEnemyTickLOD::High :
+		distance < MediumLODDistance ? (int32)EEnemyTickLOD::Medium : (int32)EEnemyTickLOD::Low;
+
+	// *** Drop One Bucket When Outside the Camera Cone
+	bool bIsOnScreen = FVector::DotProduct(InViewpoint.GetRotation().GetForwardVector(), toEnemy / distance) > CosHalfFOV;
+	if (!bIsOnScreen)
+		lod = FMath::Max(lod - 1, (int32)EEnemyTickLOD::Low);
+
+	return (float)lod;
+}
@@ -0,0 +1,215 @@
+/*
+* Author: Eyan Martucci
+* Description: Measures how many frames pass between the lock on input and the first frame each system
+*	acts on it (camera, targeting arrow and player rotation). Percentiles go to the stat group and CSV,
+*	LockOn.DumpInputLatency logs them and writes every sample to Saved/Benchmarks.
+*/
+
+#include "Subsystems/InputLatencySubsystem.h"
+
+#include "HAL/IConsoleManager.h"		// For console variables and commands
+#include "Misc/FileHelper.h"			// For SaveStringToFile
+#include "Misc/Paths.h"					// For ProjectSavedDir
+#include "LockOnTargetingStats.h"		// For latency stats
+
+
+static TAutoConsoleVariable<bool> CVarTrackInputLatency(
+	TEXT("LockOn.TrackInputLatency"), true,
+	TEXT("If true, frames between the lock on input and the camera, arrow and player rotation reacting are recorded."));
+
+static TAutoConsoleVariable<int32> CVarInputLatencyMaxSamples(
+	TEXT("LockOn.InputLatencyMaxSamples"), 1024,
+	TEXT("Number of latency samples kept for percentiles and the CSV, older samples are dropped."));
+
+static TAutoConsoleVariable<int32> CVarInputLatencyTimeoutFrames(
+	TEXT("LockOn.InputLatencyTimeoutFrames"), 30,
+	TEXT("Consumers that haven't acted on an input after this many frames are not recorded (e.g. no target to rotate toward)."));
+
+static FAutoConsoleCommandWithWorldAndArgs DumpInputLatencyCommand(
+	TEXT("LockOn.DumpInputLatency"),
+	TEXT("Logs lock on input latency percentiles and writes the samples to Saved/Benchmarks. Usage: LockOn.DumpInputLatency [reset]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+
+		UInputLatencySubsystem* latency = World ? World->GetSubsystem<UInputLatencySubsystem>() : nullptr;
+		if (!latency) return;
+
+		latency->DumpSamples();
+		if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+			latency->ResetSamples();
+	}));
+
+
+static const TCHAR* GetConsumerName(ELockOnLatencyConsumer Consumer) {
+
+	switch (Consumer) {
+	case ELockOnLatencyConsumer::TargetingCamera:	return TEXT("TargetingCamera");
+	case ELockOnLatencyConsumer::TargetingArrow:	return TEXT("TargetingArrow");
+	case ELockOnLatencyConsumer::PlayerRotation:	return TEXT("PlayerRotation");
+	default:										return TEXT("Unknown");
+	}
+}
+
+
+bool UInputLatencySubsystem::IsEnabled() {
+	return CVarTrackInputLatency.GetValueOnGameThread();
+}
+
+
+void UInputLatencySubsystem::BeginInput() {
+
+	if (!IsEnabled()) return;
+
+	// Consumers still waiting on the previous input are dropped, they never acted on it
+	InputFrame = GFrameCounter;
+	InputTime = FPlatformTime::Seconds();
+	InputIndex++;
+	PendingConsumers = (1 << (uint8)ELockOnLatencyConsumer::Num) - 1;
+}
+
+
+void UInputLatencySubsystem::MarkConsumed(ELockOnLatencyConsumer Consumer) {
+
+	const uint8 consumerBit = 1 << (uint8)Consumer;
+	if (!(PendingConsumers & consumerBit)) return;		// Called every frame, nothing to do once recorded
+
+	PendingConsumers &= ~consumerBit;
+
+	const int32 frames = (int32)(GFrameCounter - InputFrame);
+	if (frames > CVarInputLatencyTimeoutFrames.GetValueOnGameThread()) {
+		PendingConsumers = 0;			// Input is stale, stop waiting on the other consumers too
+		return;
+	}
+
+	RecordSample(Consumer, frames, (float)((FPlatformTime::Seconds() - InputTime) * 1000.0));
+}
+
+
+void UInputLatencySubsystem::ResetSamples() {
+
+	Samples.Reset();
+
+	for (uint8 i = 0; i < (uint8)ELockOnLatencyConsumer::Num; i++)
+		UpdatePercentileStats((ELockOnLatencyConsumer)i);
+}
+
+
+void UInputLatencySubsystem::RecordSample(ELockOnLatencyConsumer Consumer, int32 Frames, float Ms) {
+
+	const int32 maxSamples = FMath::Max(CVarInputLatencyMaxSamples.GetValueOnGameThread(), 1);
+	if (Samples.Num() >= maxSamples)
+		Samples.RemoveAt(0, Samples.Num() - maxSamples + 1, EAllowShrinking::No);		// One input per key press, so shifting is cheap
+
+	FInputLatencySample& sample = Samples.AddDefaulted_GetRef();
+	sample.InputIndex = InputIndex;
+	sample.Consumer = Consumer;
+	sample.Frames = Frames;
+	sample.Ms = Ms;
+
+	// *** Per Sample CSV Values
+	switch (Consumer) {
+	case ELockOnLatencyConsumer::TargetingCamera:
+		CSV_CUSTOM_STAT(LockOnTargeting, InputLatencyCameraFrames, Frames, ECsvCustomStatOp::Set);
+		break;
+	case ELockOnLatencyConsumer::TargetingArrow:
+		CSV_CUSTOM_STAT(LockOnTargeting, InputLatencyArrowFrames, Frames, ECsvCustomStatOp::Set);
+		break;
+	case ELockOnLatencyConsumer::PlayerRotation:
+		CSV_CUSTOM_STAT(LockOnTargeting, InputLatencyRotationFrames, Frames, ECsvCustomStatOp::Set);
+		break;
+	default:
+		break;
+	}
+
+	UpdatePercentileStats(Consumer);
+}
+
+
+void UInputLatencySubsystem::UpdatePercentileStats(ELockOnLatencyConsumer Consumer) const {
+
+	float p50Frames, p95Frames, p50Ms, p95Ms;
+	int32 numSamples;
+	GetPercentiles(Consumer, p50Frames, p95Frames, p50Ms, p95Ms, numSamples);
+
+	switch (Consumer) {
+	case ELockOnLatencyConsumer::TargetingCamera:
+		SET_FLOAT_STAT(STAT_LockOnInputLatencyCameraP50, p50Frames);
+		SET_FLOAT_STAT(STAT_LockOnInputLatencyCameraP95, p95Frames);
+		SET_FLOAT_STAT(STAT_LockOnInputLatencyCameraP95Ms, p95Ms);
+		break;
+	case ELockOnLatencyConsumer::TargetingArrow:
+		SET_FLOAT_STAT(STAT_LockOnInputLatencyArrowP50, p50Frames);
+		SET_FLOAT_STAT(STAT_LockOnInputLatencyArrowP95, p95Frames);
+		break;
+	case ELockOnLatencyConsumer::PlayerRotation:
+		SET_FLOAT_STAT(STAT_LockOnInputLatencyRotationP50, p50Frames);
+		SET_FLOAT_STAT(STAT_LockOnInputLatencyRotationP95, p95Frames);
+		break;
+	default:
+		break;
+	}
+}
+
+
+void UInputLatencySubsystem::GetPercentiles(ELockOnLatencyConsumer Consumer,
+	float& P50Frames, float& P95Frames, float& P50Ms, float& P95Ms, int32& NumSamples) const {
+
+	TArray<float, TInlineAllocator<256>> sortedFrames;
+	TArray<float, TInlineAllocator<256>> sortedMs;
+
+	for (const FInputLatencySample& sample : Samples) {
+		if (sample.Consumer != Consumer) continue;
+
+		sortedFrames.Add((float)sample.Frames);
+		sortedMs.Add(sample.Ms);
+	}
+
+	NumSamples = sortedFrames.Num();
+	P50Frames = P95Frames = P50Ms = P95Ms = 0.0f;
+	if (NumSamples == 0) return;
+
+	sortedFrames.Sort();
+	sortedMs.Sort();
+
+	auto percentile = [NumSamples](const TArray<float, TInlineAllocator<256>>& sorted, float pct) {
+		return sorted[FMath::Clamp(FMath::FloorToInt32(pct * (NumSamples - 1)), 0, NumSamples - 1)];
+	};
+
+	P50Frames = percentile(sortedFrames, 0.50f);
+	P95Frames = percentile(sortedFrames, 0.95f);
+	P50Ms = percentile(sortedMs, 0.50f);
+	P95Ms = percentile(sortedMs, 0.95f);
+}
+
+
+void UInputLatencySubsystem::DumpSamples() {
+
+	// *** Log Percentiles
+	FString summary = TEXT("consumer,samples,p50Frames,p95Frames,p50Ms,p95Ms\n");
+
+	for (uint8 i = 0; i < (uint8)ELockOnLatencyConsumer::Num; i++) {
+
+		float p50Frames, p95Frames, p50Ms, p95Ms;
+		int32 numSamples;
+		GetPercentiles((ELockOnLatencyConsumer)i, p50Frames, p95Frames, p50Ms, p95Ms, numSamples);
+
+		UE_LOG(LogTemp, Display, TEXT("Input latency %s: %d samples, p50 %.0f frames (%.2fms), p95 %.0f frames (%.2fms)"),
+			GetConsumerName((ELockOnLatencyConsumer)i), numSamples, p50Frames, p50Ms, p95Frames, p95Ms);
+
+		summary += FString::Printf(TEXT("%s,%d,%.0f,%.0f,%.3f,%.3f\n"),
+			GetConsumerName((ELockOnLatencyConsumer)i), numSamples, p50Frames, p95Frames, p50Ms, p95Ms);
+	}
+
+	// *** Write Samples and Percentiles
+	FString csv = TEXT("input,consumer,frames,ms\n");
+	for (const FInputLatencySample& sample : Samples) {
+		csv += FString::Printf(TEXT("%u,%s,%d,%.3f\n"),
+			sample.InputIndex, GetConsumerName(sample.Consumer), sample.Frames, sample.Ms);
+	}
+
+	const FString basePath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") /
+		FString::Printf(TEXT("LockOnInputLatency-%s"), *FDateTime::Now().ToString());
+	FFileHelper::SaveStringToFile(csv, *(basePath + TEXT(".csv")));
+	FFileHelper::SaveStringToFile(summary, *(basePath + TEXT("-Percentiles.csv")));
+
+	UE_LOG(LogTemp, Display, TEXT("Input latency samples written to %s.csv"), *basePath);
+}
@@ -0,0 +1,170 @@
+/*
+* Author: Eyan Martucci
+* Description: Queues enemy move requests and finds their paths asynchronously. Only a fixed number of
+*	path queries start each frame (closest to the player first), and a request is dropped when the
+*	agent is already heading to almost the same destination.
+*/
+
+#include "Subsystems/PathRequestSubsystem.h"
+
+#include "Controllers/EnemyAIController.h"		// For AEnemyAIController
+#include "NavigationSystem.h"					// For FindPathAsync
+#include "Navigation/PathFollowingComponent.h"	// For EPathFollowingStatus
+#include "Kismet/GameplayStatics.h"				// For GetPlayerPawn
+#include "HAL/IConsoleManager.h"				// For console variables
+#include "LockOnTargetingStats.h"				// For path request stats
+#include "Subsystems/DeterministicSimSubsystem.h"	// For synchronous paths in deterministic runs
+
+
+static TAutoConsoleVariable<int32> CVarPathRequestsPerFrame(
+	TEXT("LockOn.PathRequestsPerFrame"), 8,
+	TEXT("Maximum number of async path queries started per frame."));
+
+static TAutoConsoleVariable<float> CVarPathCoalesceTolerance(
+	TEXT("LockOn.PathCoalesceTolerance"), 150.0f,
+	TEXT("A new request is dropped if the agent is already moving to a destination closer than this."));
+
+
+TStatId UPathRequestSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPathRequestSubsystem, STATGROUP_Tickables);
+}
+
+
+// Starts async queries for the pending requests closest to the player until the frame budget is used
+void UPathRequestSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+	LOCKON_SCOPED_TIMER(STAT_LockOnPathRequests, EnemyAI, PathRequests);
+
+	UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!navSystem) return;
+
+	APawn* player = UGameplayStatics::GetPlayerPawn(this, 0);
+	const FVector playerLocation = player ? player->GetActorLocation() : FVector::ZeroVector;
+
+	// *** Gather Pending Requests and Remove Destroyed Controllers
+	TArray<TPair<float, AEnemyAIController*>, TInlineAllocator<64>> pending;
+
+	for (auto it = AgentStates.CreateIterator(); it; ++it) {
+		AEnemyAIController* controller = it.Key().Get();
+		if (!controller) {
+			it.RemoveCurrent();
+			continue;
+		}
+
+		if (it.Value().bPending && controller->GetPawn())
+			pending.Emplace(FVector::DistSquared(controller->GetPawn()->GetActorLocation(), playerLocation), controller);
+	}
+
+	// *** Start the Closest Requests First
+	pending.Sort([](const TPair<float, AEnemyAIController*>& A, const TPair<float, AEnemyAIController*>& B) {
+		return A.Key < B.Key; });
+
+	const int32 numToIssue = FMath::Min(pending.Num(), CVarPathRequestsPerFrame.GetValueOnGameThread());
+
+	for (int32 i = 0; i < numToIssue; i++) {
+		AEnemyAIController* controller = pending[i].Value;
+		FAgentPathState& state = AgentStates.FindChecked(controller);
+		state.bPending = false;
+
+		FPathFindingQuery query;
+		if (!controller->BuildPathQuery(state.PendingRequest, query)) continue;
+
+		if (state.QueryId != INVALID_NAVQUERYID)
+			navSystem->AbortAsyncFindPathRequest(state.QueryId);
+
+		// *** Deterministic Runs Find the Path Now (async results land on whichever frame the worker finishes)
+		if (UDeterministicSimSubsystem::IsEnabled()) {
+			const FAIMoveRequest moveRequest = state.PendingRequest;
+			state.QueryId = INVALID_NAVQUERYID;
+			state.LastDestination = GetRequestDestination(moveRequest);
+			state.bHasDestination = true;
+
+			FPathFindingResult result = navSystem->FindPathSync(controller->GetNavAgentPropertiesRef(), query);
+			if (result.IsSuccessful() && result.Path.IsValid())
+				controller->OnAsyncPathFound(moveRequest, result.Path);		// Can add requests, state isn't used after this
+			else
+				state.bHasDestination = false;
+			continue;
+		}
+
+		state.QueryId = navSystem->FindPathAsync(controller->GetNavAgentPropertiesRef(), query,
+			FNavPathQueryDelegate::CreateUObject(this, &UPathRequestSubsystem::OnPathFound,
+				TWeakObjectPtr<AEnemyAIController>(controller), state.PendingRequest));
+
+		state.LastDestination = GetRequestDestination(state.PendingRequest);
+		state.bHasDestination = true;
+	}
+
+	NumPending = pending.Num() - numToIssue;
+	INC_DWORD_STAT_BY(STAT_LockOnPathRequestsIssued, numToIssue);
+	SET_DWORD_STAT(STAT_LockOnPathRequestsPending, NumPending);
+	CSV_CUSTOM_STAT(EnemyAI, PathRequestsIssued, numToIssue, ECsvCustomStatOp::Set);
+}
+
+
+// Queues a request unless the agent is already moving or about to move to nearly the same place
+void UPathRequestSubsystem::RequestMove(AEnemyAIController* Controller, const FAIMoveRequest& MoveRequest) {
+
+	if (!Controller) return;
+
+	FAgentPathState& state = AgentStates.FindOrAdd(Controller);
+	const FVector destination = GetRequestDestination(MoveRequest);
+	const float tolerance = CVarPathCoalesceTolerance.GetValueOnGameThread();
+
+	// *** Coalesce With the Request Already Pending, in Flight or Being Followed
+	bool bIsMoving = state.bPending || state.QueryId != INVALID_NAVQUERYID ||
+		Controller->GetMoveStatus() == EPathFollowingStatus::Moving;
+
+	if (bIsMoving && state.bHasDestination && FVector::DistSquared(destination, state.LastDestination) < FMath::Square(tolerance)) {
+		INC_DWORD_STAT(STAT_LockOnPathRequestsCoalesced);
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_LockOnPathRequestsQueued);
+	state.PendingRequest = MoveRequest;
+	state.bPending = true;
+	state.LastDestination = destination;
+	state.bHasDestination = true;
+}
+
+
+void UPathRequestSubsystem::CancelRequests(AEnemyAIController* Controller) {
+
+	FAgentPathState* state = AgentStates.Find(Controller);
+	if (!state) return;
+
+	if (state->QueryId != INVALID_NAVQUERYID) {
+		if (UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+			navSystem->AbortAsyncFindPathRequest(state->QueryId);
+	}
+
+	state->bPending = false;
+	state->QueryId = INVALID_NAVQUERYID;
+	state->bHasDestination = false;
+}
+
+
+// Hands a finished path to its controller if it's still the latest query for that agent
+void UPathRequestSubsystem::OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path,
+	TWeakObjectPtr<AEnemyAIController> Controller, FAIMoveRequest MoveRequest) {
+
+	AEnemyAIController* controller = Controller.Get();
+	FAgentPathState* state = controller ? AgentStates.Find(controller) : nullptr;
+	if (!state || state->QueryId != QueryId) return;
+
+	state->QueryId = INVALID_NAVQUERYID;
+
+	if (Result == ENavigationQueryResult::Success && Path.IsValid())
+		controller->OnAsyncPathFound(MoveRequest, Path);
+	else
+		state->bHasDestination = false;		// Let the next request for this destination through
+}
+
+
+FVector UPathRequestSubsystem::GetRequestDestination(const FAIMoveRequest& MoveRequest) {
+
+	if (MoveRequest.IsMoveToActorRequest() && MoveRequest.GetGoalActor())
+		return MoveRequest.GetGoalActor()->GetActorLocation();
+
+	return MoveRequest.GetGoalLocation();
+}
@@ -0,0 +1,166 @@
+/*
+* Author: Eyan Martucci
+* Description: Caches pools of reachable roam destinations per navmesh region. Pools are refilled
+*	a few points at a time under a per frame time budget, so enemies that start roaming on the
+*	same frame take a point from a pool in O(1) instead of each running a navmesh query.
+*/
+
+#include "Subsystems/RoamPointSubsystem.h"
+
+#include "NavigationSystem.h"			// For GetRandomReachablePointInRadius
+#include "HAL/IConsoleManager.h"		// For console variables
+#include "LockOnTargetingStats.h"		// For roam point stats
+#include "Subsystems/DeterministicSimSubsystem.h"	// For a fixed refill count in deterministic runs
+
+
+static TAutoConsoleVariable<float> CVarRoamRefillBudgetMs(
+	TEXT("LockOn.RoamRefillBudgetMs"), 0.5f,
+	TEXT("Game thread time per frame spent refilling roam point pools."));
+
+static TAutoConsoleVariable<int32> CVarRoamRefillPointsDeterministic(
+	TEXT("LockOn.RoamRefillPointsDeterministic"), 8,
+	TEXT("Roam points refilled per frame in deterministic runs, which can't use a time budget."));
+
+static TAutoConsoleVariable<bool> CVarUseRoamPointPools(
+	TEXT("LockOn.UseRoamPointPools"), true,
+	TEXT("If false, every roam point request runs its own navmesh query (for comparison)."));
+
+
+TStatId URoamPointSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URoamPointSubsystem, STATGROUP_Tickables);
+}
+
+
+// Refills queued pools until the frame budget is used up, then publishes the stats
+void URoamPointSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+	LOCKON_SCOPED_TIMER(STAT_LockOnRoamPointRefill, EnemyAI, RoamPointRefill);
+
+	const double budgetEnd = FPlatformTime::Seconds() + CVarRoamRefillBudgetMs.GetValueOnGameThread() / 1000.0;
+	const bool bDeterministic = UDeterministicSimSubsystem::IsEnabled();
+	const int32 maxDeterministicPoints = CVarRoamRefillPointsDeterministic.GetValueOnGameThread();
+	int32 numQueries = 0;
+
+	// *** Refill Regions One Point at a Time Until the Budget Runs Out
+	while (RefillQueue.Num() > 0 &&
+		(bDeterministic ? numQueries++ < maxDeterministicPoints : FPlatformTime::Seconds() < budgetEnd)) {
+
+		FRoamPointPool* pool = Pools.Find(RefillQueue[0]);
+		FVector point;
+
+		bool bAdded = pool && pool->Points.Num() < PoolSize && QueryRoamPoint(*pool, point);
+		if (bAdded)
+			pool->Points.Add(point);
+
+		// Move on once the pool is full or the region can't produce points
+		if (!bAdded || pool->Points.Num() >= PoolSize) {
+			if (pool) pool->bQueuedForRefill = false;
+			RefillQueue.RemoveAt(0, EAllowShrinking::No);
+		}
+	}
+
+	// *** Stats
+	WorstFrameQueryMs = FMath::Max(WorstFrameQueryMs, FrameQueryMs);
+	SET_FLOAT_STAT(STAT_LockOnRoamPointHitRate, GetHitRate() * 100.0f);
+	SET_FLOAT_STAT(STAT_LockOnRoamPointWorstFrameMs, WorstFrameQueryMs);
+	CSV_CUSTOM_STAT(EnemyAI, RoamPointQueryMs, (float)FrameQueryMs, ECsvCustomStatOp::Set);
+	FrameQueryMs = 0.0;
+}
+
+
+// Hands out a cached point for the region containing Origin
+bool URoamPointSubsystem::GetRoamPoint(const FVector& Origin, FVector& OutPoint) {
+
+	NumRequests++;
+	INC_DWORD_STAT(STAT_LockOnRoamPointRequests);
+
+	const FIntPoint region = GetRegionCoord(Origin);
+	FRoamPointPool& pool = FindOrAddPool(region, Origin);
+
+	if (!CVarUseRoamPointPools.GetValueOnGameThread()) {
+		INC_DWORD_STAT(STAT_LockOnRoamPointMisses);
+		return QueryRoamPoint(pool, OutPoint);
+	}
+
+	// *** Cache Hit
+	if (pool.Points.Num() > 0) {
+		NumHits++;
+		OutPoint = pool.Points.Pop(EAllowShrinking::No);
+
+		if (pool.Points.Num() < LowWaterMark)
+			QueueRefill(region, pool);
+		return true;
+	}
+
+	// *** Cache Miss, Query Now and Let the Pool Fill Up for Next Time
+	INC_DWORD_STAT(STAT_LockOnRoamPointMisses);
+	QueueRefill(region, pool);
+	return QueryRoamPoint(pool, OutPoint);
+}
+
+
+void URoamPointSubsystem::PrewarmRegion(const FVector& Origin) {
+
+	const FIntPoint region = GetRegionCoord(Origin);
+	QueueRefill(region, FindOrAddPool(region, Origin));
+}
+
+
+void URoamPointSubsystem::SetRoamRadius(float NewRoamRadius) {
+
+	if (NewRoamRadius <= 0.0f || NewRoamRadius == RoamRadius) return;
+
+	RoamRadius = NewRoamRadius;
+	Pools.Reset();
+	RefillQueue.Reset();
+}
+
+
+// Finds a region's pool, a new pool samples around the navmesh point nearest the region center
+URoamPointSubsystem::FRoamPointPool& URoamPointSubsystem::FindOrAddPool(const FIntPoint& Region, const FVector& Origin) {
+
+	FRoamPointPool& pool = Pools.FindOrAdd(Region);
+	if (pool.bHasSampleOrigin) return pool;
+
+	// Retried on the next request if the navigation system isn't ready yet
+	UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!navSystem) return pool;
+
+	const float halfSize = GetRegionSize() * 0.5f;
+	FVector regionCenter((Region.X + 0.5f) * GetRegionSize(), (Region.Y + 0.5f) * GetRegionSize(), Origin.Z);
+	FNavLocation projected;
+
+	if (navSystem->ProjectPointToNavigation(regionCenter, projected, FVector(halfSize, halfSize, halfSize)))
+		pool.SampleOrigin = projected.Location;
+	else
+		pool.SampleOrigin = Origin;		// Region center is off the navmesh, sample around the first requester instead
+
+	pool.bHasSampleOrigin = true;
+	return pool;
+}
+
+
+void URoamPointSubsystem::QueueRefill(const FIntPoint& Region, FRoamPointPool& Pool) {
+
+	if (Pool.bQueuedForRefill || !Pool.bHasSampleOrigin) return;
+
+	Pool.bQueuedForRefill = true;
+	RefillQueue.Add(Region);
+}
+
+
+bool URoamPointSubsystem::QueryRoamPoint(const FRoamPointPool& Pool, FVector& OutPoint) {
+
+	UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!navSystem || !Pool.bHasSampleOrigin) return false;
+
+	const double startTime = FPlatformTime::Seconds();
+
+	FNavLocation result;
+	bool bFound = navSystem->GetRandomReachablePointInRadius(Pool.SampleOrigin, GetSampleRadius(), result);
+	if (bFound)
+		OutPoint = result.Location;
+
+	FrameQueryMs += (FPlatformTime::Seconds() - startTime) * 1000.0;
+	return bFound;
+}
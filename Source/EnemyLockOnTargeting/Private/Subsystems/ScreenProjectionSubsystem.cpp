@@ -0,0 +1,279 @@
+/*
+* Author: Eyan Martucci
+* Description: Projects every registered target to the screen once per frame, after the camera update,
+*	four at a time with the view projection matrix. Lock on target scoring and enemy healthbar culling
+*	read the cached screen position, depth and on screen flag instead of each doing camera math.
+*/
+
+#include "Subsystems/ScreenProjectionSubsystem.h"
+#include "Subsystems/TargetableRegistry.h"		// For the registered target locations
+#include "Camera/PlayerCameraManager.h"			// For GetCameraCacheView
+#include "Components/SceneComponent.h"			// For culled component visibility
+#include "Kismet/GameplayStatics.h"				// For GetPlayerController and GetViewProjectionMatrix
+#include "Math/VectorRegister.h"				// For VectorRegister4Float
+#include "HAL/IConsoleManager.h"				// For console variables
+#include "Misc/ScopeExit.h"						// For ON_SCOPE_EXIT
+#include "LockOnTargetingStats.h"				// For projection stats
+
+
+static TAutoConsoleVariable<bool> CVarUseScreenProjectionCache(
+	TEXT("LockOn.UseScreenProjectionCache"), true,
+	TEXT("If true, registered targets are projected once per frame for target scoring and healthbar culling."));
+
+static TAutoConsoleVariable<float> CVarScreenCullMargin(
+	TEXT("LockOn.ScreenCullMargin"), 0.15f,
+	TEXT("How far past the screen edge (in NDC, the screen spans -1 to 1) an owner can go before its culled components are hidden.\n")
+	TEXT("Healthbars sit above the actor location, so they are still visible when the location just left the screen."));
+
+
+void FScreenProjectionTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+	const FGraphEventRef& MyCompletionGraphEvent) {
+
+	if (Subsystem && TickType != LEVELTICK_ViewportsOnly)
+		Subsystem->UpdateProjections();
+}
+
+
+bool UScreenProjectionSubsystem::IsEnabled() {
+	return CVarUseScreenProjectionCache.GetValueOnGameThread();
+}
+
+
+void UScreenProjectionSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+
+	Super::OnWorldBeginPlay(InWorld);
+
+	TargetableRegistry = InWorld.GetSubsystem<UTargetableRegistry>();
+
+	// Camera managers update between the tickables and TG_PostUpdateWork
+	TickFunction.Subsystem = this;
+	TickFunction.TickGroup = TG_PostUpdateWork;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = true;
+	TickFunction.bTickEvenWhenPaused = true;		// Menus over a paused game still move the camera
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+
+void UScreenProjectionSubsystem::Deinitialize() {
+
+	if (TickFunction.IsTickFunctionRegistered())
+		TickFunction.UnRegisterTickFunction();
+
+	TickFunction.Subsystem = nullptr;
+	CulledComponents.Reset();
+	Super::Deinitialize();
+}
+
+
+void UScreenProjectionSubsystem::UpdateProjections() {
+
+	LOCKON_SCOPED_TIMER(STAT_LockOnScreenProjection, LockOnTargeting, ScreenProjection);
+
+	bHasView = false;
+	ProjectedActors.Reset();
+	ON_SCOPE_EXIT { UpdateCulledComponents(); };		// Shows everything again when there is no view
+
+	if (!IsEnabled() || !TargetableRegistry) return;
+
+	// *** Get This Frame's Camera
+	APlayerController* playerController = UGameplayStatics::GetPlayerController(GetWorld(), 0);
+	if (!playerController || !playerController->PlayerCameraManager) return;
+
+	FMinimalViewInfo view = playerController->PlayerCameraManager->GetCameraCacheView();
+
+	int32 viewportX, viewportY;
+	playerController->GetViewportSize(viewportX, viewportY);
+	if (viewportX <= 0 || viewportY <= 0) return;
+
+	if (!view.bConstrainAspectRatio)
+		view.AspectRatio = (float)viewportX / (float)viewportY;
+
+	// Locations are made relative to the camera in floats, so the matrix is built with the camera at the origin
+	ViewLocation = view.Location;
+	view.Location = FVector::ZeroVector;
+
+	FMatrix viewMatrix, projectionMatrix, viewProjectionMatrix;
+	UGameplayStatics::GetViewProjectionMatrix(view, viewMatrix, projectionMatrix, viewProjectionMatrix);
+	ViewProjection = FMatrix44f(viewProjectionMatrix);
+	bHasView = true;
+
+	// *** Copy Relative Locations Into Padded Scratch Arrays
+	const TConstArrayView<float> locationsX = TargetableRegistry->GetLocationsX();
+	const TConstArrayView<float> locationsY = TargetableRegistry->GetLocationsY();
+	const TConstArrayView<float> locationsZ = TargetableRegistry->GetLocationsZ();
+	const int32 numTargets = locationsX.Num();
+	const int32 paddedNum = Align(numTargets, 4);
+
+	RelativeX.SetNumUninitialized(paddedNum, EAllowShrinking::No);
+	RelativeY.SetNumUninitialized(paddedNum, EAllowShrinking::No);
+	RelativeZ.SetNumUninitialized(paddedNum, EAllowShrinking::No);
+	ScreenX.SetNumUninitialized(paddedNum, EAllowShrinking::No);
+	ScreenY.SetNumUninitialized(paddedNum, EAllowShrinking::No);
+	Depths.SetNumUninitialized(paddedNum, EAllowShrinking::No);
+	OnScreenFlags.SetNumUninitialized(paddedNum, EAllowShrinking::No);
+
+	const float viewX = (float)ViewLocation.X;
+	const float viewY = (float)ViewLocation.Y;
+	const float viewZ = (float)ViewLocation.Z;
+
+	for (int32 i = 0; i < numTargets; i++) {
+		RelativeX[i] = locationsX[i] - viewX;
+		RelativeY[i] = locationsY[i] - viewY;
+		RelativeZ[i] = locationsZ[i] - viewZ;
+	}
+
+	// Padding sits behind the camera, so it is never on screen
+	for (int32 i = numTargets; i < paddedNum; i++) {
+		RelativeX[i] = RelativeY[i] = RelativeZ[i] = 0.0f;
+	}
+
+	// *** Project 4 Targets at a Time (row vectors: clip = x * M[0] + y * M[1] + z * M[2] + M[3])
+	const FMatrix44f& m = ViewProjection;
+	const VectorRegister4Float m00 = VectorSetFloat1(m.M[0][0]), m10 = VectorSetFloat1(m.M[1][0]), m20 = VectorSetFloat1(m.M[2][0]), m30 = VectorSetFloat1(m.M[3][0]);
+	const VectorRegister4Float m01 = VectorSetFloat1(m.M[0][1]), m11 = VectorSetFloat1(m.M[1][1]), m21 = VectorSetFloat1(m.M[2][1]), m31 = VectorSetFloat1(m.M[3][1]);
+	const VectorRegister4Float m03 = VectorSetFloat1(m.M[0][3]), m13 = VectorSetFloat1(m.M[1][3]), m23 = VectorSetFloat1(m.M[2][3]), m33 = VectorSetFloat1(m.M[3][3]);
+	const VectorRegister4Float minW = VectorSetFloat1(UE_KINDA_SMALL_NUMBER);
+	int32 numOnScreen = 0;
+
+	for (int32 i = 0; i < paddedNum; i += 4) {
+
+		const VectorRegister4Float x = VectorLoad(RelativeX.GetData() + i);
+		const VectorRegister4Float y = VectorLoad(RelativeY.GetData() + i);
+		const VectorRegister4Float z = VectorLoad(RelativeZ.GetData() + i);
+
+		const VectorRegister4Float clipX = VectorMultiplyAdd(x, m00, VectorMultiplyAdd(y, m10, VectorMultiplyAdd(z, m20, m30)));
+		const VectorRegister4Float clipY = VectorMultiplyAdd(x, m01, VectorMultiplyAdd(y, m11, VectorMultiplyAdd(z, m21, m31)));
+		const VectorRegister4Float clipW = VectorMultiplyAdd(x, m03, VectorMultiplyAdd(y, m13, VectorMultiplyAdd(z, m23, m33)));
+
+		// In front: w > 0, on screen: |x| <= w and |y| <= w
+		const VectorRegister4Float inFront = VectorCompareGT(clipW, minW);
+		const VectorRegister4Float onScreen = VectorBitwiseAnd(inFront, VectorBitwiseAnd(
+			VectorCompareLE(VectorAbs(clipX), clipW), VectorCompareLE(VectorAbs(clipY), clipW)));
+		const int32 mask = VectorMaskBits(onScreen);
+
+		// Behind the camera divides by the small number instead, those positions are never reported
+		const VectorRegister4Float invW = VectorReciprocalAccurate(VectorMax(clipW, minW));
+		VectorStore(VectorMultiply(clipX, invW), ScreenX.GetData() + i);
+		VectorStore(VectorMultiply(clipY, invW), ScreenY.GetData() + i);
+		VectorStore(clipW, Depths.GetData() + i);
+
+		for (int32 lane = 0; lane < 4; lane++) {
+			OnScreenFlags[i + lane] = (mask >> lane) & 1;
+		}
+		numOnScreen += FMath::CountBits((uint64)mask);
+	}
+
+	ProjectedActors.Append(TargetableRegistry->GetTargetActors().GetData(), numTargets);
+
+	SET_DWORD_STAT(STAT_LockOnTargetsProjected, numTargets);
+	SET_DWORD_STAT(STAT_LockOnTargetsOnScreen, numOnScreen);
+}
+
+
+int32 UScreenProjectionSubsystem::FindProjectionIndex(AActor* Actor) const {
+
+	if (!TargetableRegistry) return INDEX_NONE;
+
+	// Registry indices move on register and unregister, so the cached entry must still hold the same actor
+	const int32 index = TargetableRegistry->GetTargetIndex(Actor);
+	return ProjectedActors.IsValidIndex(index) && ProjectedActors[index] == Actor ? index : INDEX_NONE;
+}
+
+
+bool UScreenProjectionSubsystem::GetScreenPosition(AActor* Actor, FVector2f& OutScreenPosition, float* OutDepth) const {
+
+	if (!bHasView || !IsValid(Actor)) return false;
+
+	float depth;
+	const int32 index = FindProjectionIndex(Actor);
+
+	if (index != INDEX_NONE) {
+		OutScreenPosition = FVector2f(ScreenX[index], ScreenY[index]);
+		depth = Depths[index];
+	}
+	else if (!ProjectRelative(FVector3f(Actor->GetActorLocation() - ViewLocation), OutScreenPosition, depth)) {
+		return false;
+	}
+
+	if (OutDepth)
+		*OutDepth = depth;
+
+	return depth > UE_KINDA_SMALL_NUMBER;
+}
+
+
+void UScreenProjectionSubsystem::RegisterCulledComponent(AActor* Owner, USceneComponent* Component) {
+
+	if (!Owner || !Component) return;
+
+	FCulledComponent& culled = CulledComponents.AddDefaulted_GetRef();
+	culled.Owner = Owner;
+	culled.Component = Component;
+	culled.bVisible = Component->IsVisible();
+}
+
+
+void UScreenProjectionSubsystem::UnregisterCulledComponent(AActor* Owner) {
+
+	for (int32 i = CulledComponents.Num() - 1; i >= 0; i--) {
+		if (CulledComponents[i].Owner.Get() != Owner) continue;
+
+		SetCulledVisibility(CulledComponents[i], true);
+		CulledComponents.RemoveAtSwap(i, EAllowShrinking::No);
+	}
+}
+
+
+// Flips visibility only when an owner crosses the screen edge, the widget layer skips hidden components entirely
+void UScreenProjectionSubsystem::UpdateCulledComponents() {
+
+	const float maxOffset = 1.0f + FMath::Max(CVarScreenCullMargin.GetValueOnGameThread(), 0.0f);
+
+	for (int32 i = CulledComponents.Num() - 1; i >= 0; i--) {
+
+		FCulledComponent& culled = CulledComponents[i];
+		AActor* owner = culled.Owner.Get();
+		if (!owner || !culled.Component.IsValid()) {
+			CulledComponents.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		FVector2f screenPosition;
+		const bool bVisible = !bHasView || (GetScreenPosition(owner, screenPosition) &&
+			FMath::Abs(screenPosition.X) <= maxOffset && FMath::Abs(screenPosition.Y) <= maxOffset);
+
+		SetCulledVisibility(culled, bVisible);
+	}
+}
+
+
+void UScreenProjectionSubsystem::SetCulledVisibility(FCulledComponent& Culled, bool bVisible) {
+
+	if (Culled.bVisible == bVisible) return;
+
+	Culled.bVisible = bVisible;
+	if (USceneComponent* component = Culled.Component.Get())
+		component->SetVisibility(bVisible);
+}
+
+
+bool UScreenProjectionSubsystem::IsOnScreen(AActor* Actor) const {
+
+	if (!bHasView) return true;		// Nothing culled until the first update
+
+	const int32 index = FindProjectionIndex(Actor);
+	return index == INDEX_NONE || OnScreenFlags[index] != 0;
+}
+
+
+// Scalar version of the batch projection, for actors that aren't in the cache
+bool UScreenProjectionSubsystem::ProjectRelative(const FVector3f& Relative, FVector2f& OutScreenPosition, float& OutDepth) const {
+
+	const FVector4f clip = ViewProjection.TransformFVector4(FVector4f(Relative, 1.0f));
+	OutDepth = clip.W;
+	if (clip.W <= UE_KINDA_SMALL_NUMBER) return false;
+
+	OutScreenPosition = FVector2f(clip.X / clip.W, clip.Y / clip.W);
+	return true;
+}
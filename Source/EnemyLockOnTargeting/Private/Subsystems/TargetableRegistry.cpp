@@ -0,0 +1,368 @@
+/*
+* Author: Eyan Martucci
+* Description: World subsystem that stores every targetable actor and its location
+*	so targeting queries don't need a physics overlap or a tag interface lookup.
+*	Actors are also bucketed into a uniform 2D hash grid so queries only visit nearby cells.
+*	Tags that queries filter on are compiled to bits, so the tag check is a single AND per candidate.
+*/
+
+#include "Subsystems/TargetableRegistry.h"
+
+#include "GameFramework/Actor.h"		// For AActor
+#include "HAL/IConsoleManager.h"		// For console variables and commands
+#include "LockOnTargetingStats.h"		// For targeting stats
+
+
+static TAutoConsoleVariable<bool> CVarUseSpatialGrid(
+	TEXT("LockOn.UseSpatialGrid"), true,
+	TEXT("If true, targetable registry queries only visit grid cells overlapping the query sphere."));
+
+static TAutoConsoleVariable<float> CVarTargetMoveThreshold(
+	TEXT("LockOn.TargetMoveThreshold"), 25.0f,
+	TEXT("Distance a target must move inside its cell before the cell version changes."));
+
+static TAutoConsoleVariable<bool> CVarValidateSpatialGrid(
+	TEXT("LockOn.ValidateSpatialGrid"), false,
+	TEXT("If true, every grid query is compared against the brute force query and mismatches are reported."));
+
+// Compares the tag interface lookup, the stored container lookup and the compiled tag bits on synthetic candidates
+static FAutoConsoleCommand BenchmarkTagFilterCommand(
+	TEXT("LockOn.BenchmarkTagFilter"),
+	TEXT("Times the targetable tag check per candidate. Usage: LockOn.BenchmarkTagFilter [Candidates=1000] [Iterations=1000] [Tag=Targetable]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+
+		const int32 numCandidates = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+		const int32 numIterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 1000;
+		const FGameplayTag tag = FGameplayTag::RequestGameplayTag(FName(Args.Num() > 2 ? *Args[2] : TEXT("Targetable")), false);
+
+		if (!tag.IsValid()) {
+			UE_LOG(LogTemp, Warning, TEXT("LockOn.BenchmarkTagFilter: unknown gameplay tag"));
+			return;
+		}
+
+		// *** Every Other Candidate Has the Tag
+		TArray<FGameplayTagContainer> candidateTags;
+		TArray<uint64> candidateMasks;
+		for (int32 i = 0; i < numCandidates; i++) {
+			candidateTags.Add(i % 2 == 0 ? FGameplayTagContainer(tag) : FGameplayTagContainer());
+			candidateMasks.Add(i % 2 == 0 ? 1 : 0);
+		}
+
+		auto timeNsPerCandidate = [numCandidates, numIterations](TFunctionRef<int32()> filterAll) {
+			int32 matches = 0;
+			const double startTime = FPlatformTime::Seconds();
+			for (int32 i = 0; i < numIterations; i++)
+				matches += filterAll();
+			const double ns = (FPlatformTime::Seconds() - startTime) * 1e9 / ((double)numCandidates * numIterations);
+			return TPair<double, int32>(ns, matches);
+		};
+
+		// *** Tag Interface (GetOwnedGameplayTags appends into a temporary container)
+		const TPair<double, int32> interfaceResult = timeNsPerCandidate([&]() {
+			int32 matches = 0;
+			for (const FGameplayTagContainer& tags : candidateTags) {
+				FGameplayTagContainer ownedTags;
+				ownedTags.AppendTags(tags);
+				matches += ownedTags.HasTag(tag) ? 1 : 0;
+			}
+			return matches;
+		});
+
+		// *** Stored Container
+		const TPair<double, int32> containerResult = timeNsPerCandidate([&]() {
+			int32 matches = 0;
+			for (const FGameplayTagContainer& tags : candidateTags)
+				matches += tags.HasTag(tag) ? 1 : 0;
+			return matches;
+		});
+
+		// *** Compiled Tag Bits
+		const uint64 requiredMask = 1;
+		const TPair<double, int32> maskResult = timeNsPerCandidate([&]() {
+			int32 matches = 0;
+			for (uint64 mask : candidateMasks)
+				matches += (mask & requiredMask) == requiredMask ? 1 : 0;
+			return matches;
+		});
+
+		UE_LOG(LogTemp, Display, TEXT("Tag filter, %d candidates x %d iterations (ns per candidate):"), numCandidates, numIterations);
+		UE_LOG(LogTemp, Display, TEXT("  Tag interface:    %7.2f  (%d matches)"), interfaceResult.Key, interfaceResult.Value);
+		UE_LOG(LogTemp, Display, TEXT("  Stored container: %7.2f  (%d matches)"), containerResult.Key, containerResult.Value);
+		UE_LOG(LogTemp, Display, TEXT("  Tag bits:         %7.2f  (%d matches)"), maskResult.Key, maskResult.Value);
+	}));
+
+
+// Adds an actor and its current location to the registry
+void UTargetableRegistry::RegisterTarget(AActor* Actor, const FGameplayTagContainer& Tags) {
+
+	if (!Actor || ActorToIndex.Contains(Actor)) return;
+
+	FVector location = Actor->GetActorLocation();
+	FIntPoint cell = GetCellCoord(location.X, location.Y);
+	int32 index = Actors.Num();
+
+	ActorToIndex.Add(Actor, index);
+	Actors.Add(Actor);
+	LocationsX.Add(location.X);
+	LocationsY.Add(location.Y);
+	LocationsZ.Add(location.Z);
+	TargetTagMasks.Add(ComputeTagMask(Tags));
+	TargetTags.Add(Tags);
+	TargetThreats.Add(0.0f);
+	TargetCells.Add(cell);
+	StampedLocations.Add(location);
+	AddToCell(index, cell);
+}
+
+
+// Removes an actor from the registry
+void UTargetableRegistry::UnregisterTarget(AActor* Actor) {
+
+	const int32* index = ActorToIndex.Find(Actor);
+	if (!index) return;
+
+	RemoveTargetAtSwap(*index);
+}
+
+
+// Stores the new tags of a registered actor and recomputes its query bits
+void UTargetableRegistry::UpdateTargetTags(AActor* Actor, const FGameplayTagContainer& Tags) {
+
+	const int32* index = ActorToIndex.Find(Actor);
+	if (!index) return;
+
+	TargetTags[*index] = Tags;
+	TargetTagMasks[*index] = ComputeTagMask(Tags);
+}
+
+
+void UTargetableRegistry::SetTargetThreat(AActor* Actor, float Threat) {
+
+	if (const int32* index = ActorToIndex.Find(Actor))
+		TargetThreats[*index] = Threat;
+}
+
+
+// Assigns the tag the next free bit and recomputes every mask, queries should resolve their tags once up front
+uint64 UTargetableRegistry::GetTagQueryMask(const FGameplayTag& Tag) {
+
+	if (!Tag.IsValid()) return 0;
+
+	int32 bit = QueryTags.IndexOfByKey(Tag);
+	if (bit == INDEX_NONE) {
+
+		if (!ensureMsgf(QueryTags.Num() < 64, TEXT("Targetable registry is out of tag query bits, %s can't be queried"), *Tag.ToString()))
+			return 0;
+
+		bit = QueryTags.Add(Tag);
+
+		for (int32 i = 0; i < Actors.Num(); i++)
+			TargetTagMasks[i] = ComputeTagMask(TargetTags[i]);
+	}
+
+	return 1ull << bit;
+}
+
+
+// Sets the bit of every query tag the container has (parent tags match like HasTag)
+uint64 UTargetableRegistry::ComputeTagMask(const FGameplayTagContainer& Tags) const {
+
+	uint64 mask = 0;
+	for (int32 bit = 0; bit < QueryTags.Num(); bit++) {
+		if (Tags.HasTag(QueryTags[bit]))
+			mask |= 1ull << bit;
+	}
+	return mask;
+}
+
+
+// Stores the latest location of a registered actor, only touches the grid when it changes cells
+void UTargetableRegistry::UpdateTargetLocation(AActor* Actor, const FVector& Location) {
+
+	const int32* indexPtr = ActorToIndex.Find(Actor);
+	if (!indexPtr) return;
+
+	const int32 index = *indexPtr;
+	LocationsX[index] = Location.X;
+	LocationsY[index] = Location.Y;
+	LocationsZ[index] = Location.Z;
+
+	// *** Move to New Cell if Crossed a Cell Boundary
+	FIntPoint newCell = GetCellCoord(Location.X, Location.Y);
+	if (newCell != TargetCells[index]) {
+		RemoveFromCell(index, TargetCells[index]);
+		AddToCell(index, newCell);
+		TargetCells[index] = newCell;
+		StampedLocations[index] = Location;
+	}
+
+	// *** Bump Cell Version if Moved Noticeably Inside the Same Cell
+	else {
+		const float threshold = CVarTargetMoveThreshold.GetValueOnGameThread();
+
+		if (FVector::DistSquared(Location, StampedLocations[index]) > threshold * threshold) {
+			BumpCellVersion(newCell);
+			StampedLocations[index] = Location;
+		}
+	}
+}
+
+
+// Finds all registered actors with the required tag bits inside the sphere
+void UTargetableRegistry::QueryTargetsInSphere(const FVector& Center, float Radius, uint64 RequiredTagMask,
+	const TArray<AActor*>& ActorsToIgnore, FTargetCandidates& OutTargets) const
+{
+	INC_DWORD_STAT(STAT_LockOnRegistryQueries);
+	CSV_CUSTOM_STAT(LockOnTargeting, RegistryQueries, 1, ECsvCustomStatOp::Accumulate);
+
+	if (RequiredTagMask == 0) return;		// Invalid tag, nothing can match it
+
+	if (!CVarUseSpatialGrid.GetValueOnGameThread()) {
+		QueryTargetsInSphereLinear(Center, Radius, RequiredTagMask, ActorsToIgnore, OutTargets);
+		return;
+	}
+
+	const float radiusSqr = Radius * Radius;
+	const int32 firstOutIndex = OutTargets.Num();
+
+	// *** Visit Only the Cells Covered by the Sphere
+	FIntPoint minCell = GetCellCoord(Center.X - Radius, Center.Y - Radius);
+	FIntPoint maxCell = GetCellCoord(Center.X + Radius, Center.Y + Radius);
+
+	for (int32 cellX = minCell.X; cellX <= maxCell.X; cellX++) {
+		for (int32 cellY = minCell.Y; cellY <= maxCell.Y; cellY++) {
+
+			const TArray<int32>* cellIndices = GridCells.Find(FIntPoint(cellX, cellY));
+			if (!cellIndices) continue;
+
+			for (int32 index : *cellIndices) {
+				if (IsValidTargetInSphere(index, Center, radiusSqr, RequiredTagMask, ActorsToIgnore))
+					AddCandidate(index, OutTargets);
+			}
+		}
+	}
+
+	// *** Optionally Compare Against Brute Force Results
+	if (CVarValidateSpatialGrid.GetValueOnGameThread()) {
+		FTargetCandidates linearTargets;
+		QueryTargetsInSphereLinear(Center, Radius, RequiredTagMask, ActorsToIgnore, linearTargets);
+
+		bool bMatches = linearTargets.Num() == OutTargets.Num() - firstOutIndex;
+		for (int32 i = firstOutIndex; bMatches && i < OutTargets.Num(); i++)
+			bMatches = linearTargets.Actors.Contains(OutTargets.Actors[i]);
+
+		ensureMsgf(bMatches, TEXT("Targetable registry grid query found %d targets but brute force found %d"),
+			OutTargets.Num() - firstOutIndex, linearTargets.Num());
+	}
+}
+
+
+// Combines the versions of every cell covered by the sphere
+uint32 UTargetableRegistry::GetRegionVersion(const FVector& Center, float Radius) const {
+
+	FIntPoint minCell = GetCellCoord(Center.X - Radius, Center.Y - Radius);
+	FIntPoint maxCell = GetCellCoord(Center.X + Radius, Center.Y + Radius);
+
+	uint32 version = HashCombine(GetTypeHash(minCell), GetTypeHash(maxCell));	// Covered cells changing counts as a change
+
+	for (int32 cellX = minCell.X; cellX <= maxCell.X; cellX++) {
+		for (int32 cellY = minCell.Y; cellY <= maxCell.Y; cellY++) {
+
+			if (const uint32* cellVersion = CellVersions.Find(FIntPoint(cellX, cellY)))
+				version += *cellVersion;
+		}
+	}
+
+	return version;
+}
+
+
+// Rebuilds every cell using the new cell size
+void UTargetableRegistry::SetGridCellSize(float NewCellSize) {
+
+	if (NewCellSize <= 0.0f || FMath::IsNearlyEqual(NewCellSize, GridCellSize)) return;
+
+	GridCellSize = NewCellSize;
+	GridCells.Reset();
+
+	for (int32 i = 0; i < Actors.Num(); i++) {
+		TargetCells[i] = GetCellCoord(LocationsX[i], LocationsY[i]);
+		AddToCell(i, TargetCells[i]);
+	}
+}
+
+
+// Checks every registered actor, used as the reference for the grid query
+void UTargetableRegistry::QueryTargetsInSphereLinear(const FVector& Center, float Radius, uint64 RequiredTagMask,
+	const TArray<AActor*>& ActorsToIgnore, FTargetCandidates& OutTargets) const
+{
+	const float radiusSqr = Radius * Radius;
+	const int32 numTargets = Actors.Num();
+
+	for (int32 i = 0; i < numTargets; i++) {
+		if (IsValidTargetInSphere(i, Center, radiusSqr, RequiredTagMask, ActorsToIgnore))
+			AddCandidate(i, OutTargets);
+	}
+}
+
+
+// Returns true if the entry is inside the sphere, has the required tag bits and isn't ignored
+bool UTargetableRegistry::IsValidTargetInSphere(int32 Index, const FVector& Center, float RadiusSqr,
+	uint64 RequiredTagMask, const TArray<AActor*>& ActorsToIgnore) const
+{
+	// *** Check Distance Using Stored Locations
+	const float dx = LocationsX[Index] - Center.X;
+	const float dy = LocationsY[Index] - Center.Y;
+	const float dz = LocationsZ[Index] - Center.Z;
+
+	if (dx * dx + dy * dy + dz * dz > RadiusSqr) return false;
+
+	// *** Check Tag and Ignore List Only for Actors in Range
+	if ((TargetTagMasks[Index] & RequiredTagMask) != RequiredTagMask) return false;
+
+	return !ActorsToIgnore.Contains(Actors[Index]);
+}
+
+
+// Moves the last entry into the removed slot so the arrays stay contiguous
+void UTargetableRegistry::RemoveTargetAtSwap(int32 Index) {
+
+	const int32 lastIndex = Actors.Num() - 1;
+	ActorToIndex.Remove(Actors[Index]);
+	RemoveFromCell(Index, TargetCells[Index]);
+
+	if (Index != lastIndex) {					// Last entry is about to move into the removed slot
+		ActorToIndex[Actors[lastIndex]] = Index;
+
+		TArray<int32>& lastCell = GridCells.FindChecked(TargetCells[lastIndex]);
+		lastCell[lastCell.IndexOfByKey(lastIndex)] = Index;
+	}
+
+	Actors.RemoveAtSwap(Index, EAllowShrinking::No);
+	LocationsX.RemoveAtSwap(Index, EAllowShrinking::No);
+	LocationsY.RemoveAtSwap(Index, EAllowShrinking::No);
+	LocationsZ.RemoveAtSwap(Index, EAllowShrinking::No);
+	TargetTagMasks.RemoveAtSwap(Index, EAllowShrinking::No);
+	TargetTags.RemoveAtSwap(Index, EAllowShrinking::No);
+	TargetThreats.RemoveAtSwap(Index, EAllowShrinking::No);
+	TargetCells.RemoveAtSwap(Index, EAllowShrinking::No);
+	StampedLocations.RemoveAtSwap(Index, EAllowShrinking::No);
+}
+
+
+// Adds a registry index to a grid cell
+void UTargetableRegistry::AddToCell(int32 Index, const FIntPoint& Cell) {
+
+	GridCells.FindOrAdd(Cell).Add(Index);
+	BumpCellVersion(Cell);
+}
+
+
+// Removes a registry index from a grid cell, empty cells are kept to avoid reallocating
+void UTargetableRegistry::RemoveFromCell(int32 Index, const FIntPoint& Cell) {
+
+	if (TArray<int32>* cellIndices = GridCells.Find(Cell))
+		cellIndices->RemoveSingleSwap(Index, EAllowShrinking::No);
+
+	BumpCellVersion(Cell);
+}
@@ -0,0 +1,107 @@
+/*
+* Author: Eyan Martucci
+* Description: Lock on candidates sorted by yaw around the player, measured from the camera direction.
+*	Rebuilt from each selection query and re-sorted incrementally in between, so switching left or right
+*	is a binary search for the neighboring yaw, optionally wrapping around behind the camera.
+*/
+
+#include "Targeting/TargetAngularRing.h"
+
+#include "Targeting/TargetSelectionKernel.h"	// For FTargetCandidates
+#include "Algo/BinarySearch.h"					// For LowerBound and UpperBound
+#include "GameFramework/Actor.h"				// For AActor
+
+
+void FTargetAngularRing::Rebuild(const FTargetCandidates& Candidates, const FVector& Origin, float ReferenceYaw) {
+
+	Reset();
+	LastOrigin = Origin;
+	LastReferenceYaw = ReferenceYaw;
+
+	for (int32 i = 0; i < Candidates.Num(); i++) {
+		const FVector location(Candidates.LocationsX[i], Candidates.LocationsY[i], Candidates.LocationsZ[i]);
+		Actors.Add(Candidates.Actors[i]);
+		Yaws.Add(GetRelativeYaw(location, Origin, ReferenceYaw));
+	}
+
+	UpdateYaws(Origin, ReferenceYaw, [](AActor* actor) { return IsValid(actor); });	// Sorts the new entries
+}
+
+
+void FTargetAngularRing::UpdateYaws(const FVector& Origin, float ReferenceYaw, TFunctionRef<bool(AActor*)> KeepPredicate) {
+
+	LastOrigin = Origin;
+	LastReferenceYaw = ReferenceYaw;
+
+	// *** Drop Lost Actors and Recompute Yaws
+	for (int32 i = Actors.Num() - 1; i >= 0; i--) {
+
+		AActor* actor = Actors[i].Get();
+		if (!actor || !KeepPredicate(actor)) {
+			Actors.RemoveAt(i, EAllowShrinking::No);
+			Yaws.RemoveAt(i, EAllowShrinking::No);
+			continue;
+		}
+
+		Yaws[i] = GetRelativeYaw(actor->GetActorLocation(), Origin, ReferenceYaw);
+	}
+
+	// *** Insertion Sort (nearly sorted, only actors that passed a neighbor or crossed behind the camera move)
+	for (int32 i = 1; i < Yaws.Num(); i++) {
+
+		const float yaw = Yaws[i];
+		if (Yaws[i - 1] <= yaw) continue;
+
+		TWeakObjectPtr<AActor> actor = Actors[i];
+		int32 j = i;
+		for (; j > 0 && Yaws[j - 1] > yaw; j--) {
+			Yaws[j] = Yaws[j - 1];
+			Actors[j] = Actors[j - 1];
+		}
+		Yaws[j] = yaw;
+		Actors[j] = actor;
+	}
+}
+
+
+AActor* FTargetAngularRing::FindNeighbor(const AActor* Current, bool bRight, bool bWrap) const {
+
+	const int32 num = Actors.Num();
+	if (num == 0) return nullptr;
+
+	// *** Find Where the Current Target Sits in the Ring (straight ahead if there is none)
+	const float currentYaw = IsValid(Current) ? GetRelativeYaw(Current->GetActorLocation(), LastOrigin, LastReferenceYaw) : 0.0f;
+
+	int32 index = bRight ? Algo::UpperBound(Yaws, currentYaw) : Algo::LowerBound(Yaws, currentYaw) - 1;
+	const int32 step = bRight ? 1 : -1;
+
+	// *** Walk to the First Valid Neighbor
+	for (int32 visited = 0; visited < num; visited++, index += step) {
+
+		if (index < 0 || index >= num) {
+			if (!bWrap) return nullptr;
+			index = (index + num) % num;
+		}
+
+		AActor* actor = Actors[index].Get();
+		if (IsValid(actor) && actor != Current)
+			return actor;
+	}
+
+	return nullptr;
+}
+
+
+void FTargetAngularRing::Reset() {
+
+	Actors.Reset();
+	Yaws.Reset();
+}
+
+
+float FTargetAngularRing::GetRelativeYaw(const FVector& Location, const FVector& Origin, float ReferenceYaw) {
+
+	const FVector direction = Location - Origin;
+	const float yaw = FMath::RadiansToDegrees(FMath::Atan2((float)direction.Y, (float)direction.X));
+	return FRotator::NormalizeAxis(yaw - ReferenceYaw);
+}
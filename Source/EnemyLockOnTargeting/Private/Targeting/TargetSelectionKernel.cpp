@@ -0,0 +1,117 @@
+/*
+* Author: Eyan Martucci
+* Description: Vectorized kernel that scores packed target candidates and picks the nearest,
+*	next left and next right target in a single pass.
+*/
+
+#include "Targeting/TargetSelectionKernel.h"
+
+#include "Math/VectorRegister.h"		// For VectorRegister4Float
+
+
+// Scores all candidates with 4 wide vector math, then selects targets with one scalar sweep
+void TargetSelection::SelectTargets(FTargetCandidates& Candidates, const FVector& Origin,
+	const FVector& RightVector, float MaxDistanceSqr, int32 DirectionalExcludeIndex, FTargetSelectionResult& OutResult,
+	int32 NumRanked)
+{
+	OutResult.NearestIndex = INDEX_NONE;
+	OutResult.SecondNearestIndex = INDEX_NONE;
+	OutResult.LeftIndex = INDEX_NONE;
+	OutResult.RightIndex = INDEX_NONE;
+	OutResult.RankedIndices.Reset();		// Keeps any heap memory from a larger NumRanked
+
+	const int32 numCandidates = Candidates.Num();
+	if (numCandidates == 0) return;
+
+	// *** Pad Arrays to a Multiple of 4 so Every Load is Full Width
+	const int32 paddedNum = Align(numCandidates, 4);
+	const int32 numPadding = paddedNum - numCandidates;
+
+	Candidates.LocationsX.AddZeroed(numPadding);
+	Candidates.LocationsY.AddZeroed(numPadding);
+	Candidates.LocationsZ.AddZeroed(numPadding);
+	Candidates.DistancesSqr.SetNumUninitialized(paddedNum, EAllowShrinking::No);
+	Candidates.RightDots.SetNumUninitialized(paddedNum, EAllowShrinking::No);
+
+	// *** Broadcast Origin and Right Vector
+	const VectorRegister4Float originX = VectorSetFloat1((float)Origin.X);
+	const VectorRegister4Float originY = VectorSetFloat1((float)Origin.Y);
+	const VectorRegister4Float originZ = VectorSetFloat1((float)Origin.Z);
+	const VectorRegister4Float rightX = VectorSetFloat1((float)RightVector.X);
+	const VectorRegister4Float rightY = VectorSetFloat1((float)RightVector.Y);
+	const VectorRegister4Float rightZ = VectorSetFloat1((float)RightVector.Z);
+
+	const float* locX = Candidates.LocationsX.GetData();
+	const float* locY = Candidates.LocationsY.GetData();
+	const float* locZ = Candidates.LocationsZ.GetData();
+	float* distSqr = Candidates.DistancesSqr.GetData();
+	float* rightDot = Candidates.RightDots.GetData();
+
+	// *** Compute Squared Distance and Right Projection 4 at a Time
+	for (int32 i = 0; i < paddedNum; i += 4) {
+
+		const VectorRegister4Float dx = VectorSubtract(VectorLoad(locX + i), originX);
+		const VectorRegister4Float dy = VectorSubtract(VectorLoad(locY + i), originY);
+		const VectorRegister4Float dz = VectorSubtract(VectorLoad(locZ + i), originZ);
+
+		VectorRegister4Float lengthSqr = VectorMultiply(dx, dx);
+		lengthSqr = VectorMultiplyAdd(dy, dy, lengthSqr);
+		lengthSqr = VectorMultiplyAdd(dz, dz, lengthSqr);
+
+		VectorRegister4Float dot = VectorMultiply(dx, rightX);
+		dot = VectorMultiplyAdd(dy, rightY, dot);
+		dot = VectorMultiplyAdd(dz, rightZ, dot);
+
+		VectorStore(lengthSqr, distSqr + i);
+		VectorStore(dot, rightDot + i);
+	}
+
+	// *** Remove Padding so Callers Only See Real Candidates
+	Candidates.LocationsX.SetNum(numCandidates, EAllowShrinking::No);
+	Candidates.LocationsY.SetNum(numCandidates, EAllowShrinking::No);
+	Candidates.LocationsZ.SetNum(numCandidates, EAllowShrinking::No);
+	Candidates.DistancesSqr.SetNum(numCandidates, EAllowShrinking::No);
+	Candidates.RightDots.SetNum(numCandidates, EAllowShrinking::No);
+
+	// *** Select Ranked Nearest, Left and Right in One Sweep
+	const int32 numRanked = FMath::Max(NumRanked, 2);
+	TArray<float, TInlineAllocator<8>> rankedDistSqr;
+	float closestRightDot = FLT_MAX;
+	float closestLeftDot = -FLT_MAX;
+
+	for (int32 i = 0; i < numCandidates; i++) {
+
+		// Insert into the short sorted ranking, equal distances keep the earlier candidate first
+		const float curDistSqr = distSqr[i];
+		if (curDistSqr < MaxDistanceSqr) {
+
+			int32 rank = rankedDistSqr.Num();
+			while (rank > 0 && curDistSqr < rankedDistSqr[rank - 1])
+				rank--;
+
+			if (rank < numRanked) {
+				if (rankedDistSqr.Num() == numRanked) {		// Full, the farthest falls off
+					rankedDistSqr.Pop(EAllowShrinking::No);
+					OutResult.RankedIndices.Pop(EAllowShrinking::No);
+				}
+				rankedDistSqr.Insert(curDistSqr, rank);
+				OutResult.RankedIndices.Insert(i, rank);
+			}
+		}
+
+		if (i == DirectionalExcludeIndex) continue;
+
+		const float curDot = rightDot[i];
+		if (curDot > 0 && curDot < closestRightDot) {			// Next closest on the right
+			closestRightDot = curDot;
+			OutResult.RightIndex = i;
+		}
+		else if (curDot < 0 && curDot > closestLeftDot) {		// Next closest on the left
+			closestLeftDot = curDot;
+			OutResult.LeftIndex = i;
+		}
+	}
+
+	if (OutResult.RankedIndices.Num() > 0) OutResult.NearestIndex = OutResult.RankedIndices[0];
+	if (OutResult.RankedIndices.Num() > 1) OutResult.SecondNearestIndex = OutResult.RankedIndices[1];
+}
@@ -0,0 +1,109 @@
+/*
+* Author: Eyan Martucci
+* Description: Caches line of sight between the player and lock on candidates. Traces are issued
+*	asynchronously and consumed the next frame, results expire after a time to live or when
+*	the player or target moves too far, so target selection never has to trace synchronously.
+*/
+
+#include "Targeting/TargetVisibilityCache.h"
+
+#include "Engine/World.h"				// For AsyncLineTraceByChannel
+#include "LockOnTargetingStats.h"		// For visibility stats
+
+
+void FTargetVisibilityCache::SetWatchedTargets(TConstArrayView<AActor*> Targets) {
+
+	for (TPair<TObjectKey<AActor>, FEntry>& pair : Entries)
+		pair.Value.bWatched = false;
+
+	for (AActor* target : Targets) {
+		FEntry& entry = Entries.FindOrAdd(target);
+		entry.Actor = target;
+		entry.bWatched = true;
+	}
+}
+
+
+void FTargetVisibilityCache::Update(UWorld* World, const FVector& ViewLocation, const AActor* Viewer, FTraceDelegate* Delegate) {
+
+	if (!World) return;
+
+	const double now = World->GetTimeSeconds();
+	int32 numTraces = 0;
+
+	for (auto it = Entries.CreateIterator(); it; ++it) {
+		FEntry& entry = it.Value();
+		AActor* target = entry.Actor.Get();
+
+		// *** Drop Entries for Destroyed or Out of Range Targets (in flight results are ignored)
+		if (!target || !entry.bWatched) {
+			if (entry.PendingTraceId != 0)
+				PendingTraces.Remove(entry.PendingTraceId);
+			it.RemoveCurrent();
+			continue;
+		}
+
+		if (entry.PendingTraceId != 0 || !NeedsTrace(entry, ViewLocation, now)) continue;
+
+		// *** Trace Asynchronously, the Result Arrives Next Frame
+		FCollisionQueryParams params(SCENE_QUERY_STAT(LockOnVisibility), true);
+		params.AddIgnoredActor(Viewer);
+		params.AddIgnoredActor(target);
+
+		entry.ViewLocation = ViewLocation;
+		entry.TargetLocation = target->GetActorLocation();
+		entry.TraceTime = now;
+		entry.PendingTraceId = NextTraceId++;
+		if (NextTraceId == 0) NextTraceId = 1;
+		PendingTraces.Add(entry.PendingTraceId, it.Key());
+
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, entry.ViewLocation, entry.TargetLocation, TraceChannel,
+			params, FCollisionResponseParams::DefaultResponseParam, Delegate, entry.PendingTraceId);
+		numTraces++;
+	}
+
+	INC_DWORD_STAT_BY(STAT_LockOnVisibilityTraces, numTraces);
+}
+
+
+void FTargetVisibilityCache::HandleTraceResult(const FTraceDatum& Datum) {
+
+	TObjectKey<AActor> key;
+	if (!PendingTraces.RemoveAndCopyValue(Datum.UserData, key)) return;		// Entry was dropped
+
+	FEntry* entry = Entries.Find(key);
+	if (!entry || entry->PendingTraceId != Datum.UserData) return;
+
+	const bool bVisible = !(Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit);
+	if (!entry->bHasResult || bVisible != entry->bVisible)	// First result can make a target selectable
+		Version++;
+
+	entry->PendingTraceId = 0;
+	entry->bHasResult = true;
+	entry->bVisible = bVisible;
+}
+
+
+bool FTargetVisibilityCache::IsVisible(const AActor* Target) const {
+
+	const FEntry* entry = Entries.Find(Target);
+	return !entry || !entry->bHasResult || entry->bVisible;
+}
+
+
+bool FTargetVisibilityCache::HasVisibleResult(const AActor* Target) const {
+
+	const FEntry* entry = Entries.Find(Target);
+	return entry && entry->bHasResult && entry->bVisible;
+}
+
+
+// True if there is no result yet, it expired, or either end moved past the threshold
+bool FTargetVisibilityCache::NeedsTrace(const FEntry& Entry, const FVector& ViewLocation, double Now) const {
+
+	if (!Entry.bHasResult || Now - Entry.TraceTime > TimeToLive) return true;
+
+	const float thresholdSqr = InvalidateDistance * InvalidateDistance;
+	return FVector::DistSquared(ViewLocation, Entry.ViewLocation) > thresholdSqr ||
+		FVector::DistSquared(Entry.Actor->GetActorLocation(), Entry.TargetLocation) > thresholdSqr;
+}
@@ -0,0 +1,173 @@
+/*
+* Author: Eyan Martucci
+* Description: Checks that targetable registry sphere queries, which only visit nearby grid cells,
+*	find exactly the targets a brute force pass over every registered target finds.
+*	Random layouts are queried, then targets are moved, unregistered and the cells resized before querying again.
+*/
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Subsystems/TargetableRegistry.h"		// Registry under test
+#include "Engine/World.h"						// For creating a transient world
+#include "GameFramework/Actor.h"				// For AActor
+#include "NativeGameplayTags.h"					// For a tag that exists without a tag table
+
+
+UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_TargetableRegistryTest, "LockOn.Test.Targetable");
+
+namespace TargetableRegistryTests
+{
+	// Reference query, same float math as the registry over its own stored locations
+	void QueryBruteForce(const UTargetableRegistry& Registry, const TSet<AActor*>& TaggedActors, const FVector& Center,
+		float Radius, const TArray<AActor*>& ActorsToIgnore, TSet<AActor*>& OutTargets)
+	{
+		const float radiusSqr = Radius * Radius;
+		TConstArrayView<AActor*> actors = Registry.GetTargetActors();
+
+		for (int32 i = 0; i < actors.Num(); i++) {
+
+			const float dx = Registry.GetLocationsX()[i] - Center.X;
+			const float dy = Registry.GetLocationsY()[i] - Center.Y;
+			const float dz = Registry.GetLocationsZ()[i] - Center.Z;
+
+			if (dx * dx + dy * dy + dz * dz <= radiusSqr && TaggedActors.Contains(actors[i]) && !ActorsToIgnore.Contains(actors[i]))
+				OutTargets.Add(actors[i]);
+		}
+	}
+
+	FVector RandomLocation(FRandomStream& Random, float HalfExtent) {
+		return FVector(Random.FRandRange(-HalfExtent, HalfExtent), Random.FRandRange(-HalfExtent, HalfExtent),
+			Random.FRandRange(-500.0f, 500.0f));
+	}
+
+	// Runs random queries against the grid and brute force, returns the number of mismatching queries
+	int32 CompareRandomQueries(FAutomationTestBase& Test, UTargetableRegistry& Registry, const TSet<AActor*>& TaggedActors,
+		uint64 TagMask, FRandomStream& Random, float HalfExtent, const TCHAR* Phase)
+	{
+		int32 numMismatches = 0;
+
+		for (int32 queryIndex = 0; queryIndex < 200; queryIndex++) {
+
+			const FVector center = RandomLocation(Random, HalfExtent);
+			const float radius = Random.FRandRange(100.0f, 6000.0f);		// From inside one cell to across several
+
+			TArray<AActor*> actorsToIgnore;
+			TConstArrayView<AActor*> actors = Registry.GetTargetActors();
+			if (actors.Num() > 0)
+				actorsToIgnore.Add(actors[Random.RandHelper(actors.Num())]);
+
+			// *** Grid Query (must not return duplicates)
+			FTargetCandidates gridCandidates;
+			Registry.QueryTargetsInSphere(center, radius, TagMask, actorsToIgnore, gridCandidates);
+
+			TSet<AActor*> gridTargets;
+			for (AActor* actor : gridCandidates.Actors)
+				gridTargets.Add(actor);
+
+			// *** Brute Force Query
+			TSet<AActor*> bruteForceTargets;
+			QueryBruteForce(Registry, TaggedActors, center, radius, actorsToIgnore, bruteForceTargets);
+
+			const bool bMatches = gridTargets.Num() == gridCandidates.Num() && gridTargets.Num() == bruteForceTargets.Num()
+				&& gridTargets.Includes(bruteForceTargets);
+
+			if (!bMatches) {
+				Test.AddError(FString::Printf(TEXT("%s: query %d at %s radius %.0f found %d targets on the grid, %d by brute force"),
+					Phase, queryIndex, *center.ToCompactString(), radius, gridCandidates.Num(), bruteForceTargets.Num()));
+				numMismatches++;
+			}
+		}
+
+		return numMismatches;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTargetableRegistryGridQueryTest, "LockOnTargeting.TargetableRegistry.GridMatchesBruteForce",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FTargetableRegistryGridQueryTest::RunTest(const FString& Parameters) {
+
+	using namespace TargetableRegistryTests;
+
+	// *** Transient World (initializing it creates the registry subsystem)
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false);
+	UTargetableRegistry* registry = world ? world->GetSubsystem<UTargetableRegistry>() : nullptr;
+
+	if (!TestNotNull(TEXT("Targetable registry"), registry)) {
+		if (world)
+			world->DestroyWorld(false);
+		return false;
+	}
+
+	const FGameplayTag tag = TAG_TargetableRegistryTest;
+	const uint64 tagMask = registry->GetTagQueryMask(tag);
+	TestNotEqual(TEXT("Tag query mask"), tagMask, (uint64)0);
+
+	const float cellSizes[] = { 2500.0f, 700.0f, 6000.0f };
+	const float halfExtent = 20000.0f;
+	const int32 numActors = 500;
+
+	for (int32 seed = 0; seed < 3; seed++) {
+
+		FRandomStream random(seed);
+		registry->SetGridCellSize(cellSizes[seed]);
+
+		// *** Random Layout, Roughly Two Thirds Tagged
+		TArray<AActor*> spawnedActors;
+		TSet<AActor*> taggedActors;
+
+		for (int32 i = 0; i < numActors; i++) {
+
+			AActor* actor = world->SpawnActor<AActor>();
+			const bool bTagged = random.FRand() < 0.66f;
+
+			registry->RegisterTarget(actor, bTagged ? FGameplayTagContainer(tag) : FGameplayTagContainer());
+			registry->UpdateTargetLocation(actor, RandomLocation(random, halfExtent));
+
+			spawnedActors.Add(actor);
+			if (bTagged)
+				taggedActors.Add(actor);
+		}
+
+		CompareRandomQueries(*this, *registry, taggedActors, tagMask, random, halfExtent, TEXT("Initial layout"));
+
+		// *** Move Targets Across Cells, Including Onto Cell Edges
+		for (int32 i = 0; i < numActors; i += 3) {
+			FVector location = RandomLocation(random, halfExtent);
+			if (i % 2 == 0)
+				location.X = FMath::RoundToFloat(location.X / cellSizes[seed]) * cellSizes[seed];
+			registry->UpdateTargetLocation(spawnedActors[i], location);
+		}
+
+		CompareRandomQueries(*this, *registry, taggedActors, tagMask, random, halfExtent, TEXT("After moving"));
+
+		// *** Unregister Some Targets (swaps the last entry into the removed slot)
+		for (int32 i = 0; i < numActors; i += 5) {
+			registry->UnregisterTarget(spawnedActors[i]);
+			taggedActors.Remove(spawnedActors[i]);
+		}
+
+		CompareRandomQueries(*this, *registry, taggedActors, tagMask, random, halfExtent, TEXT("After unregistering"));
+
+		// *** Rebuild the Grid With Another Cell Size
+		registry->SetGridCellSize(cellSizes[(seed + 1) % UE_ARRAY_COUNT(cellSizes)]);
+
+		CompareRandomQueries(*this, *registry, taggedActors, tagMask, random, halfExtent, TEXT("After resizing cells"));
+
+		// *** Clean Up for the Next Layout
+		for (AActor* actor : spawnedActors) {
+			registry->UnregisterTarget(actor);
+			actor->Destroy();
+		}
+
+		TestEqual(TEXT("Registry empty after unregistering"), registry->GetNumTargets(), 0);
+	}
+
+	world->DestroyWorld(false);
+	return true;
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS
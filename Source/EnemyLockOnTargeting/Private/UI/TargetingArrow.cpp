@@ -7,6 +7,8 @@
 
 #include "PaperSpriteComponent.h"		// For UPaperSpriteComponent
 #include "Kismet/GameplayStatics.h"		// For GetPlayerCameraManager
+#include "LockOnTargetingStats.h"		// For stats and CSV timers
+#include "Subsystems/InputLatencySubsystem.h"	// For UInputLatencySubsystem
 
 // Sets default values
 ATargetingArrow::ATargetingArrow()
@@ -28,6 +30,7 @@ void ATargetingArrow::BeginPlay()
 	Super::BeginPlay();
 	
 	DynamicArrowMat = PaperSpriteComp->CreateDynamicMaterialInstance(0);
+	InputLatency = GetWorld()->GetSubsystem<UInputLatencySubsystem>();
 	HideArrow();
 }
 
@@ -82,6 +85,7 @@ void ATargetingArrow::HideArrow() {
 
 // Updates arrow location and rotation
 void ATargetingArrow::UpdateArrow(float DeltaTime) {
+	LOCKON_SCOPED_TIMER(STAT_LockOnArrowUpdate, LockOnTargeting, ArrowUpdate);
 
 	// *** Check if Target is Destroyed
 	if (!TargetActor) {
@@ -117,5 +121,8 @@ void ATargetingArrow::UpdateArrow(float DeltaTime) {
 	targetRot.Yaw += 90.0f;		// Rotate sprite to be perpendicular to camera
 
 	SetActorRotation(targetRot);
+
+	if (bIsTargetingMode && InputLatency)
+		InputLatency->MarkConsumed(ELockOnLatencyConsumer::TargetingArrow);
 }
 
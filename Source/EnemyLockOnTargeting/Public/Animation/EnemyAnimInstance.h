@@ -22,6 +22,9 @@ public:
 	// Override the animation tick method
 	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
 
+	// Clears montages and movement variables when a pooled enemy is reused
+	void ResetAnimState();
+
 private:
 
 	// References
@@ -0,0 +1,91 @@
+/*
+* Author: Eyan Martucci
+* Description: Spawns crowds of enemies, drives the player through a scripted lock on routine,
+*	and writes frame time and memory results to a JSON report.
+*	Run headless with: EnemyLockOnTargeting TestLevel -game -nullrhi -LockOnBenchmark [-BenchmarkCounts=50,200,1000]
+*	or in game with the console command: LockOn.RunBenchmark 50 200 1000
+*	Add -LockOnDeterministic for a fixed step, seeded run whose stateChecksum matches between runs.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CrowdBenchmarkSubsystem.generated.h"
+
+
+// Results for a single enemy count
+struct FCrowdBenchmarkResult
+{
+	int32 EnemyCount = 0;
+	int32 ActiveActorCount = 0;		// Benchmark enemies still actors (not pooled) when recording ended
+	int32 ProxyCount = 0;			// Mass proxies in the world when recording ended
+	int32 NumFrames = 0;
+	float AvgFrameMs = 0.0f;
+	float P50FrameMs = 0.0f;
+	float P95FrameMs = 0.0f;
+	float P99FrameMs = 0.0f;
+	float MaxFrameMs = 0.0f;
+	float AvgGameThreadMs = 0.0f;
+	float P95GameThreadMs = 0.0f;
+	float UsedPhysicalMB = 0.0f;
+	uint32 StateChecksum = 0;		// CRC of every enemy's location at the end, equal between deterministic runs
+};
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UCrowdBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void StartBenchmark(const TArray<int32>& EnemyCounts);	// Runs one pass for every enemy count in order
+	bool IsRunning() const { return bIsRunning; }
+
+private:
+
+	enum class EBenchmarkPhase : uint8
+	{
+		Spawning,		// Spawning enemies for the current count
+		Warmup,			// Letting spawns settle before recording
+		Recording,		// Recording frame samples while driving the player
+	};
+
+	UPROPERTY()
+	class APlayerCharacter* PlayerCharacter = nullptr;
+
+	UPROPERTY()
+	TArray<class AEnemyCharacter*> SpawnedEnemies;
+
+	TArray<int32> PendingCounts;		// Enemy counts that still need a pass
+	TArray<FCrowdBenchmarkResult> Results;
+	TArray<float> FrameSamplesMs;
+	TArray<float> GameThreadSamplesMs;
+	double LastFrameRealTime = 0.0;		// DeltaTime is fixed in deterministic runs, so frame times are measured
+
+	EBenchmarkPhase Phase = EBenchmarkPhase::Spawning;
+	FRandomStream SpawnStream;			// Seeded so every run uses the same layout
+	float PhaseTimer = 0.0f;
+	float ScriptTimer = 0.0f;
+	int32 ScriptStep = 0;
+	bool bIsRunning = false;
+	bool bExitWhenFinished = false;
+	bool bStartedCsvCapture = false;	// Per-subsystem timings from the LockOnTargeting stat group go to this CSV
+
+	float SpawnRadius = 4000.0f;		// Enemies are spread inside this radius around the player
+	float WarmupTime = 3.0f;
+	float RecordTime = 10.0f;
+	int32 MaxSpawnsPerFrame = 50;		// Spread spawning over frames so the spawn hitch isn't recorded
+
+	void StartNextCount();
+	void SpawnBatch();
+	void DestroySpawnedEnemies();
+	void DriveScriptedPlayer(float DeltaTime);	// Cycles through lock on, directional switches and attacks
+	void FinishCount();
+	void WriteReport() const;
+};
@@ -9,6 +9,7 @@
 #include "GameFramework/Character.h"
 #include "GameplayTagAssetInterface.h"	// To implement IGameplayTagAssetInterface
 #include "UI/EnemyHealthbarWidget.h"	// Enemy Healthbar
+#include "Subsystems/EnemyTickLODSubsystem.h"	// EEnemyTickLOD
 #include "EnemyCharacter.generated.h"
 
 // Enemy State Enumeration (Simplified version from EnemyAIController to set movement speed)
@@ -34,6 +35,9 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the enemy is destroyed or removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -53,13 +57,24 @@ public:
 	virtual void GetOwnedGameplayTags(FGameplayTagContainer& TagContainer) const override 
 		{ TagContainer.AppendTags(GameplayTags); }
 
+	void SetGameplayTags(const FGameplayTagContainer& NewTags);	// Changes tags and updates the targetable registry's tag bits
+
 	void StartAttacking();
 	void SwitchMoveState(EEnemyMoveState newState);
 	void EnableAttackCollision();
 	void DisableAttackCollision();
 	void StopMovementOnDeath();
+	void StopBeingTargetable();		// Called on death so lock on switches to another target right away
+	void SetTickLOD(EEnemyTickLOD NewLOD);	// Changes how often this enemy and its AI controller tick
 	bool GetIsInCombat() const { return CurState != EEnemyMoveState::Roaming; }
 	UEnemyHealthbarWidget* GetHealthbarWidget() { return HealthbarWidget; }
+	class UEnemyHealth* GetHealthComponent() const { return HealthComponent; }
+
+	// *** Pooling (see UEnemyPoolSubsystem)
+	void Despawn();			// Returns the enemy to the pool, use instead of Destroy
+	void OnReleasedToPool();
+	void OnAcquiredFromPool(const FVector& Location, const FRotator& Rotation);
+	bool IsInPool() const { return bIsInPool; }
 
 
 private:
@@ -112,10 +127,33 @@ private:
 	UPROPERTY()
 	EEnemyMoveState CurState = EEnemyMoveState::Roaming;
 
+	UPROPERTY()
+	class UTargetableRegistry* TargetableRegistry = nullptr;	// Registry that lock on targeting queries for targets
+
+	UPROPERTY()
+	UEnemyTickLODSubsystem* TickLODSubsystem = nullptr;			// Lowers tick rate when far from the player or off screen
+
+	UPROPERTY()
+	class UEnemyProxySubsystem* ProxySubsystem = nullptr;		// Swaps this enemy for a Mass entity when far from the player
+
+	UPROPERTY()
+	class UEnemyPoolSubsystem* EnemyPool = nullptr;
+
+	UPROPERTY()
+	class UScreenProjectionSubsystem* ScreenProjection = nullptr;	// Hides the healthbar while this enemy is off screen
+
+	bool bIsInPool = false;		// Hidden and waiting to be reused, not registered with any subsystem
+
 	UFUNCTION()
 	void OnSwordBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
 		UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
 
 	UFUNCTION()
 	void OnMontageEnd(UAnimMontage* Montage, bool bInterrupted);
+
+	void RegisterWithSubsystems();		// Called on BeginPlay and when taken out of the pool
+	void UnregisterFromSubsystems();	// Called on EndPlay and when put in the pool
+
+	// Keeps the targetable registry location up to date whenever the capsule moves
+	void OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
 };
@@ -43,6 +43,8 @@ public:
 	void StopMoveInput();		// Stops player from moving and rotating
 	void ResumeMoveInput();		// Allows player to move and rotate
 
+	AEnemyCharacter* SpawnEnemyAtLocation(const FVector& SpawnLocation);	// Spawns EnemyToSpawn at a location
+
 	bool IsTargetingInputHeld() const { return bIsHoldingTargetingInput; }
 	class UPlayerMeleeCombat* GetMeleeCombatComponent() { return MeleeCombatComp; }
 	class UCapsuleComponent* GetSwordCollision() {return SwordCollision; }
@@ -140,6 +142,15 @@ private:
 	UPROPERTY(EditDefaultsOnly, Category = "EnemySpawning")
 	float EnemySpawnDistance = 1500.0f;
 
+	UPROPERTY(EditDefaultsOnly, Category = "EnemySpawning")	// Enemies spawned into the pool at level load so early spawns don't hitch
+	int32 EnemyPoolPrewarmCount = 32;
+
+	UPROPERTY()
+	class UEnemyPoolSubsystem* EnemyPool = nullptr;
+
+	UPROPERTY()
+	class UInputLatencySubsystem* InputLatency = nullptr;
+
 
 	UPROPERTY()
 	class UAIPerceptionStimuliSourceComponent* StimulusSource;	// Player is a stimulus source, meaning it can be detected by enemy AI perception
@@ -152,6 +163,8 @@ private:
 	bool bIsMoveInputAllowed = true;
 
 	// *** Functions
+
+	friend class UCrowdBenchmarkSubsystem;	// Drives the input functions below during scripted benchmark runs
 	
 	// Input
 	void Move(const FInputActionValue& Value);
@@ -34,6 +34,8 @@ public:
 
 	float GetHealth() const { return Health; }
 	float GetMaxHealth() const { return MaxHealth; }
+	void SetHealth(float NewHealth);	// Restores health carried over from an enemy proxy
+	void ResetHealth();					// Full health with a hidden healthbar, used when reusing a pooled enemy
 
 private:
 
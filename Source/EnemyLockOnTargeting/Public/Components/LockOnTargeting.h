@@ -9,10 +9,25 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "GameplayTagContainer.h"		// For FGameplayTag UPROPERTY
+#include "Targeting/TargetSelectionKernel.h"	// For FTargetCandidates and FTargetSelectionResult
+#include "Targeting/TargetVisibilityCache.h"	// For FTargetVisibilityCache
+#include "Targeting/TargetAngularRing.h"		// For FTargetAngularRing
+#include "UObject/ObjectKey.h"					// For TObjectKey
 #include "LockOnTargeting.generated.h"
 
 class ATargetingArrow;
 
+
+// Precompiled scorers that pick the lock on target (see TargetScoringPolicies.h)
+UENUM()
+enum class ETargetSelectionPolicy : uint8
+{
+	Nearest,			// Distance only, no extra scoring pass
+	ScreenCenter,		// Distance and angle to the middle of the screen
+	Threat,				// Distance and whether the enemy is in combat
+	Crowd				// Distance, screen center, threat and skipping recently locked targets
+};
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class ENEMYLOCKONTARGETING_API ULockOnTargeting : public UActorComponent
 {
@@ -50,15 +65,18 @@ public:
 	void OnSwitchDirectionalTargetInput(bool bGetRight);	// Switches targets to the next closest target on the left or right
 	void OnLookInput(FVector2D LookInput);	// Checks to stop camera reset or adjust targeting offset angle
 
+	// Writes targetable actors in range into OutTargets without allocating once its memory is warm.
+	//	Actors the predicate returns true for are skipped instead of being removed afterwards.
+	void QueryTargetsInRange(FTargetActorArray& OutTargets, TFunctionRef<bool(const AActor*)> ExcludePredicate);
+
+	void DumpTickOrder();				// Logs the resolved tick order of the player, targeting, spring arm and arrow
+
 
 private:
 
-	UPROPERTY(EditDefaultsOnly, Category = "Targeting")	// Gameplay tag to indicate if an actor is targetable
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting")	// Gameplay tag to indicate if an actor is targetable (non enemies also need a UTargetableComponent)
 	FGameplayTag TargetableTag;
 
-	UPROPERTY(EditDefaultsOnly, Category = "Targeting")	// The object types that can be targeted
-	TArray<TEnumAsByte<EObjectTypeQuery>> ObjectTypes;
-
 	UPROPERTY(EditDefaultsOnly, Category = "Targeting")	// Actors that will be ignored when checking for targets (self is already added)
 	TArray<AActor*> ActorsToIgnore;
 
@@ -74,6 +92,57 @@ private:
 	UPROPERTY(EditDefaultsOnly, Category = "Targeting") // How often to check for the closest enemy and place the non-targeting arrow above them
 	float UpdateNonTargetingInterval = 0.5;
 
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Policy") // How the nearest target is chosen, set per game mode
+	ETargetSelectionPolicy SelectionPolicy = ETargetSelectionPolicy::Nearest;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Policy") // Penalty for distance, normalized by the max targeting distance
+	float DistanceWeight = 1.0f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Policy") // Penalty for the squared offset from the screen center
+	float ScreenCenterWeight = 1.0f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Policy") // Bonus for enemies in combat with the player
+	float ThreatWeight = 0.5f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Policy") // Penalty for targets locked onto within the recency window
+	float RecencyWeight = 0.5f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Policy") // Seconds after a lock ends before the target no longer counts as recently locked
+	float RecencyWindow = 3.0f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Ranking") // If true, a target that dies or despawns is replaced by the next ranked target instead of ending the lock
+	bool bRetargetOnTargetLost = true;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Ranking") // If true, switching left past the leftmost target goes to the rightmost one and the other way around
+	bool bWrapDirectionalSwitch = true;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Ranking") // Number of nearest targets kept ranked between queries
+	int32 RankedTargetCount = 4;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Ranking") // How often the ranking is rebuilt from a full query, it is only reordered in between
+	float RankingRefreshInterval = 0.1f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting") // If true, the non-targeting arrow only updates when the player, camera or nearby targets change
+	bool bUseEventDrivenNonTargeting = true;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting") // Distance the player must move before the non-targeting arrow is recomputed
+	float NonTargetingPlayerMoveThreshold = 50.0f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting") // Degrees the camera yaw must change before the non-targeting arrow is recomputed
+	float NonTargetingCameraYawThreshold = 5.0f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Visibility") // If true, targets hidden behind geometry can't be locked onto
+	bool bRequireLineOfSight = true;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Visibility") // Channel used for the line of sight traces
+	TEnumAsByte<ECollisionChannel> VisibilityTraceChannel = ECC_Visibility;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Visibility") // Seconds a line of sight result is reused before tracing again
+	float VisibilityTimeToLive = 0.5f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Targeting|Visibility") // Line of sight is traced again once the player or target moves this far
+	float VisibilityInvalidateDistance = 50.0f;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Targeting")	// Reference to BP_TargetingArrow so the blueprint subclass can be spawned
 	TSubclassOf<ATargetingArrow> TargetingArrowClass;
 
@@ -100,6 +169,12 @@ private:
 	UPROPERTY()
 	AActor* PlayerActor;
 	UPROPERTY()
+	class UTargetableRegistry* TargetableRegistry;	// Stores all targetable actors and their locations
+	UPROPERTY()
+	class UInputLatencySubsystem* InputLatency;		// Records when the camera first reacts to the targeting input
+	UPROPERTY()
+	class UScreenProjectionSubsystem* ScreenProjection;	// Cached screen positions for the screen center policy
+	UPROPERTY()
 	AActor* PreviousTargetedActor;		// The last actor to be targeted
 	UPROPERTY()
 	AActor* NonTargetingActor;			// The actor with an arrow overhead in non targeting mode
@@ -110,14 +185,53 @@ private:
 	FRotator TargetingOffsetRotation;	// The offset from player rotation that the spring arm is when targeting
 	float SwitchTargetsTimer;			// Tracks time after releasing the targeting button
 	float UpdateNonTargetingTimer;		// Tracks time left until UpdateNonTargeting method is called
+	FVector LastNonTargetingPlayerLocation = FVector::ZeroVector;	// Player location at the last non-targeting recompute
+	float LastNonTargetingCameraYaw = 0.0f;		// Camera yaw at the last non-targeting recompute
+	uint32 LastNonTargetingRegionVersion = 0;	// Registry region version at the last non-targeting recompute
+	uint32 LastNonTargetingVisibilityVersion = 0;	// Visibility cache version at the last non-targeting recompute
 	bool bIsCleaningUpTargeting = false;// True if spring arm is still returning to default values after targeting is over
 	bool bCanSwitchTargets = false;		// True if the player can get a different target when pressing the switch target button
 
-	TArray<AActor*> GetAllTargetsInRange();		// Returns all actors with targetable tag within sphere overlap
+	FTargetCandidates TargetCandidates;			// Packed targets in range from the last selection query
+	FTargetSelectionResult TargetSelection;		// Nearest, left and right picks from the last selection query
+	uint64 TargetSelectionFrame = 0;			// Frame the last selection query ran on
+	uint64 TargetableTagMask = 0;				// Registry query bit of TargetableTag, resolved at BeginPlay
+	AActor* TargetSelectionExcludedActor = nullptr;	// Targeted actor when the last selection query ran
+
+	// *** Ranked Targets (kept up to date every frame so lock on input doesn't run a query)
+	TArray<TWeakObjectPtr<AActor>, TInlineAllocator<8>> RankedTargets;	// Nearest targets, nearest first
+	TWeakObjectPtr<AActor> RankedLeftTarget;	// Next target to the left at the last refresh
+	TWeakObjectPtr<AActor> RankedRightTarget;	// Next target to the right at the last refresh
+	TWeakObjectPtr<AActor> RankedDirectionalExcludedActor;	// Targeted actor when left and right were picked
+	float RankingRefreshTimer = 0.0f;			// Time left until the ranking is rebuilt from a full query
+	FTargetAngularRing TargetRing;				// Every target in range sorted by yaw, for directional switching
+	TMap<TObjectKey<AActor>, double> LastTargetedTimes;	// When each target was last locked onto, for the recency policy
+
+	FTargetVisibilityCache VisibilityCache;		// Async line of sight results for targets in range
+	FTraceDelegate VisibilityTraceDelegate;		// Bound to this component so in flight traces can't outlive it
+
+	void GatherTargetsInRange();				// Fills TargetCandidates with registered targetable actors in the targeting sphere
+	const FTargetSelectionResult& GetTargetSelection();	// Runs the selection kernel once per frame and caches the result
+	AActor* GetCandidateActor(int32 Index) const;	// Returns the candidate at index or null if invalid
 	AActor* GetNearestTarget(bool bConsiderPreviousTarget);	// Returns closest targetable actor in proximity
 	AActor* GetNextTargetInDirection(bool bCheckRight);	// Returns the next closest target to the left or right of current target
+	void UpdateTargetRanking(float DeltaTime);	// Rebuilds the ranking on an interval and reorders it every other frame
+	void RefreshTargetRanking();				// Rebuilds the ranking from a full selection query
+	void ReorderTargetRanking();				// Drops lost targets and sorts the ranked targets by current distance
+	AActor* GetRankedNearestTarget(bool bConsiderPreviousTarget);	// GetNearestTarget from the ranking, no query
+	AActor* GetRankedTargetInDirection(bool bCheckRight);	// GetNextTargetInDirection from the ranking when it is still valid
+	AActor* GetReplacementTarget(const AActor* LostTarget);	// Next ranked target after the targeted actor died or despawned
+	bool IsTargetable(AActor* Actor) const;		// Alive, visible and registered as a target
+	void RankWithSelectionPolicy();				// Re-ranks TargetCandidates with the scorer picked by SelectionPolicy
+	template<typename TScorer> void RankWithScorer(const struct FTargetScoringContext& Context);
+	void MarkRecentlyTargeted(AActor* Actor);	// Remembers when a target stopped being locked onto
 	void UpdateCameraReset(float DeltaTime);	// Rotates camera to player forward direction
 	void UpdateTargeting();						// Updates spring arm and camera to keep player and enemy in view
 	void UpdateTargetingCleanup();				// Updates spring arm to return to default values after targeting is over
 	void UpdateNonTargeting();					// Sets arrow sprite above closest target in range
+	bool ShouldUpdateNonTargeting();			// Returns true if the player, camera or targets in range changed enough
+	FVector GetTargetingSphereCenter() const;	// Center of the sphere in front of the camera that targets must be inside
+	FVector GetVisibilityViewLocation() const;	// Player eye location line of sight is traced from
+	void OnVisibilityTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum);
+	void SetupTickOrder();						// Player rotation -> targeting -> spring arm -> camera -> arrow
 };
@@ -0,0 +1,50 @@
+/*
+* Author: Eyan Martucci
+* Description: Registers its owner with the targetable registry so lock on targeting can find it.
+*	Enemies register themselves, any other actor that should be targetable needs this component.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "GameplayTagContainer.h"		// For FGameplayTagContainer
+#include "TargetableComponent.generated.h"
+
+
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class ENEMYLOCKONTARGETING_API UTargetableComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:	
+	// Sets default values for this component's properties
+	UTargetableComponent();
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	// Called when the game ends or the owner is destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+
+//*********************************************************
+
+public:
+
+	void SetTargetableTags(const FGameplayTagContainer& NewTags);	// Changes tags and updates the registry's tag bits
+
+private:
+
+	UPROPERTY(EditAnywhere, Category = "Targeting")	// Registered along with the owner's tags if it implements IGameplayTagAssetInterface
+	FGameplayTagContainer TargetableTags;
+
+	UPROPERTY()
+	class UTargetableRegistry* TargetableRegistry = nullptr;
+
+	FGameplayTagContainer GetRegisteredTags() const;	// Component tags plus the owner's tags
+
+	void OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+};
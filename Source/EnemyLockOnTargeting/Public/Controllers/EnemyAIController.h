@@ -7,6 +7,7 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
+#include "Subsystems/TimerWheel.h"		// For FTimerWheelHandle
 #include "EnemyAIController.generated.h"
 
 // Enemy State Enumeration
@@ -34,10 +35,28 @@ public:
 	virtual void Tick(float DeltaTime) override;
 
 	void OnFinishAttack();
+	void OnStateTimerExpired(EEnemyState NextState);	// Called by UEnemyStateTimerSubsystem and UEnemyDecisionSubsystem in a batch
+	void MoveToRetreatLocation(const FVector& RetreatLocation);	// Called by UEnemyDecisionSubsystem while retreating
+	void HandleTargetPerception(AActor* Actor, bool bSensed);	// Starts or stops combat when sight of the player changes
+
+	// *** Flow Field Chasing (called by UChaseFlowFieldSubsystem)
+	void OnFlowFieldChaseArrived();		// Close enough to attack
+	void OnFlowFieldChaseLost();		// Left the field, path to the target instead
+
+	AActor* GetTargetActor() const { return TargetActor; }
+
+	// *** Pooling (called by AEnemyCharacter)
+	void ActivateAI();		// Registers perception and starts roaming
+	void DeactivateAI();	// Stops all AI while the pawn is dead or pooled, keeps possession
+
+	// *** Async Pathfinding (used by UPathRequestSubsystem)
+	bool BuildPathQuery(const FAIMoveRequest& MoveRequest, FPathFindingQuery& OutQuery) const;
+	void OnAsyncPathFound(const FAIMoveRequest& MoveRequest, FNavPathSharedPtr Path);
 
 protected:
 
 	virtual void OnPossess(APawn* InPawn) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void OnMoveCompleted(FAIRequestID RequestID, const FPathFollowingResult& Result) override;
 
 private:
@@ -90,12 +109,41 @@ private:
 	UPROPERTY()
 	EEnemyState CurState = EEnemyState::RoamIdle;
 
-	float Timer = 0.0f;
+	UPROPERTY()
+	class UEnemyStateTimerSubsystem* StateTimerSubsystem = nullptr;
+
+	UPROPERTY()
+	class URoamPointSubsystem* RoamPointSubsystem = nullptr;
+
+	UPROPERTY()
+	class UPathRequestSubsystem* PathRequestSubsystem = nullptr;
+
+	UPROPERTY()
+	class UChaseFlowFieldSubsystem* ChaseFlowField = nullptr;
+
+	UPROPERTY()
+	class UEnemyPerceptionSubsystem* PerceptionSubsystem = nullptr;	// Set when shared perception replaces the sight sense
+
+	UPROPERTY()
+	class UEnemyDecisionSubsystem* DecisionSubsystem = nullptr;		// Set when per frame decisions run in the packed decision array
+
+	uint32 DecisionId = 0;
+
+	FRandomStream RandomStream;		// Per enemy so deterministic runs don't depend on other enemies' draws
+
+	// *** State Timer (RoamIdle, ChaseIdle and Retreating end when it expires)
+	float Timer = 0.0f;							// Countdown used by the per actor tick mode
+	bool bTickStateTimer = false;
+	EEnemyState TimerNextState = EEnemyState::RoamIdle;
+	FTimerHandle StateTimerHandle;				// Used by the timer manager mode
+	FTimerWheelHandle StateTimerWheelHandle;	// Used by the timer wheel mode (the decision array mode uses DecisionId)
 
 	UFUNCTION()
 	void OnTargetPerception(AActor* Actor, FAIStimulus Stimulus);
 
 	void SwitchEnemyState(EEnemyState NewState);
+	void StartStateTimer(float Duration, EEnemyState NextState);	// Switches to NextState after Duration seconds
+	void ClearStateTimer();
 	void MoveToRandomLocation();
 	void ChaseTarget();
 	void RetreatFromTarget();
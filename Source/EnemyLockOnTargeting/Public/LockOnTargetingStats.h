@@ -0,0 +1,104 @@
+/*
+* Author: Eyan Martucci
+* Description: Stat group, counters, CSV categories and memory tracking tags shared by the gameplay code
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"								// For stat declarations
+#include "HAL/LowLevelMemTracker.h"						// For LLM tags
+#include "ProfilingDebugging/CsvProfiler.h"				// For CSV categories
+#include "ProfilingDebugging/CpuProfilerTrace.h"		// For Unreal Insights trace scopes
+
+DECLARE_STATS_GROUP(TEXT("LockOnTargeting"), STATGROUP_LockOnTargeting, STATCAT_Advanced);
+
+// *** Hot Path Timers
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Targeting Tick"), STAT_LockOnTargetingTick, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Target Selection"), STAT_LockOnTargetSelection, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Player Tick"), STAT_LockOnPlayerTick, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Targeting Arrow Update"), STAT_LockOnArrowUpdate, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemy AI Tick"), STAT_LockOnEnemyAITick, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemy State Timer Wheel"), STAT_LockOnStateTimerWheel, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Roam Point Refill"), STAT_LockOnRoamPointRefill, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Path Requests"), STAT_LockOnPathRequests, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Chase Flow Field Update"), STAT_LockOnFlowFieldUpdate, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Shared Perception Update"), STAT_LockOnPerceptionUpdate, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemy Proxy Update"), STAT_LockOnEnemyProxyUpdate, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemy Proxy Swaps"), STAT_LockOnEnemyProxySwaps, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemy Decisions"), STAT_LockOnEnemyDecisions, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemy Spawn"), STAT_LockOnEnemySpawn, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Screen Projection"), STAT_LockOnScreenProjection, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Player Anim Update"), STAT_LockOnPlayerAnimUpdate, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemy Anim Update"), STAT_LockOnEnemyAnimUpdate, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+
+// *** Target Queries
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Target Queries"), STAT_LockOnTargetQueries, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Registry Sphere Queries"), STAT_LockOnRegistryQueries, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Candidates Scanned"), STAT_LockOnCandidatesScanned, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Target Query Allocations"), STAT_LockOnTargetQueryAllocations, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Targets Occluded"), STAT_LockOnTargetsOccluded, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Line of Sight Traces"), STAT_LockOnVisibilityTraces, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Target Ranking Refreshes"), STAT_LockOnTargetRankingRefreshes, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Retargets on Target Lost"), STAT_LockOnRetargets, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Targets Projected"), STAT_LockOnTargetsProjected, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Targets On Screen"), STAT_LockOnTargetsOnScreen, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Target Query Scratch Memory"), STAT_LockOnTargetQueryScratchMemory, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+
+// *** Non-Targeting Arrow Updates
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Non-Targeting Recomputes Triggered"), STAT_LockOnNonTargetingTriggered, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Non-Targeting Recomputes Skipped"), STAT_LockOnNonTargetingSkipped, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+
+// *** Enemy AI and Animation
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Enemy State Switches"), STAT_LockOnEnemyStateSwitches, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Enemy State Timers Fired"), STAT_LockOnStateTimersFired, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Enemy State Timers Pending"), STAT_LockOnStateTimersPending, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Roam Point Requests"), STAT_LockOnRoamPointRequests, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Roam Point Cache Misses"), STAT_LockOnRoamPointMisses, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Roam Point Cache Hit Rate (%)"), STAT_LockOnRoamPointHitRate, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Roam Point Worst Frame Query (ms)"), STAT_LockOnRoamPointWorstFrameMs, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Requests Queued"), STAT_LockOnPathRequestsQueued, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Requests Coalesced"), STAT_LockOnPathRequestsCoalesced, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Queries Started"), STAT_LockOnPathRequestsIssued, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Path Requests Waiting"), STAT_LockOnPathRequestsPending, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Flow Field Cells Sampled"), STAT_LockOnFlowFieldCellsSampled, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Flow Field Rebuilds"), STAT_LockOnFlowFieldRebuilds, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Flow Field Chasers"), STAT_LockOnFlowFieldChasers, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Perception Listeners In Cone"), STAT_LockOnPerceptionInCone, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Perception Sight Traces"), STAT_LockOnPerceptionTraces, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Perception Validation Matches"), STAT_LockOnPerceptionValidationMatches, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Perception Validation Mismatches"), STAT_LockOnPerceptionValidationMismatches, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Enemy Proxies"), STAT_LockOnEnemyProxies, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Enemy Proxy Promotions"), STAT_LockOnEnemyProxyPromotions, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Enemy Proxy Demotions"), STAT_LockOnEnemyProxyDemotions, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Enemy Pool Reuses"), STAT_LockOnEnemyPoolHits, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Enemy Pool Misses"), STAT_LockOnEnemyPoolMisses, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Enemy Pool Free"), STAT_LockOnEnemyPoolFree, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Enemy Decision States"), STAT_LockOnEnemyDecisionStates, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Enemy Decision Actions"), STAT_LockOnEnemyDecisionActions, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Input Latency Camera p50 (frames)"), STAT_LockOnInputLatencyCameraP50, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Input Latency Camera p95 (frames)"), STAT_LockOnInputLatencyCameraP95, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Input Latency Camera p95 (ms)"), STAT_LockOnInputLatencyCameraP95Ms, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Input Latency Arrow p50 (frames)"), STAT_LockOnInputLatencyArrowP50, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Input Latency Arrow p95 (frames)"), STAT_LockOnInputLatencyArrowP95, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Input Latency Rotation p50 (frames)"), STAT_LockOnInputLatencyRotationP50, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Input Latency Rotation p95 (frames)"), STAT_LockOnInputLatencyRotationP95, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Montage Plays"), STAT_LockOnMontagePlays, STATGROUP_LockOnTargeting, ENEMYLOCKONTARGETING_API);
+
+// *** CSV Categories (captured with -csvCaptureFrames or csvprofile start/stop)
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(ENEMYLOCKONTARGETING_API, LockOnTargeting);
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(ENEMYLOCKONTARGETING_API, EnemyAI);
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(ENEMYLOCKONTARGETING_API, GameplayAnim);
+
+LLM_DECLARE_TAG_API(LockOnTargeting, ENEMYLOCKONTARGETING_API);
+
+// Times a hot path scope with a cycle stat, an Insights trace event and a CSV timer
+#define LOCKON_SCOPED_TIMER(Stat, CsvCategory, Name) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Name); \
+	CSV_SCOPED_TIMING_STAT(CsvCategory, Name)
+
+// Counts a montage play in both the stat group and the CSV
+#define LOCKON_COUNT_MONTAGE_PLAY() \
+	INC_DWORD_STAT(STAT_LockOnMontagePlays); \
+	CSV_CUSTOM_STAT(GameplayAnim, MontagePlays, 1, ECsvCustomStatOp::Accumulate)
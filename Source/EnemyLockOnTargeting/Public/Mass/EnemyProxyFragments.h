@@ -0,0 +1,35 @@
+/*
+* Author: Eyan Martucci
+* Description: Mass fragments for background enemies. Far away enemies only exist as entities with a
+*	transform, velocity and this roam state until they are promoted to a full AEnemyCharacter.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"					// For FMassFragment and FMassTag
+#include "Controllers/EnemyAIController.h"		// For EEnemyState
+#include "EnemyProxyFragments.generated.h"
+
+
+// Roam state and health carried by a background enemy
+USTRUCT()
+struct ENEMYLOCKONTARGETING_API FEnemyProxyFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	EEnemyState State = EEnemyState::RoamIdle;
+	float StateTimer = 0.0f;					// Time left in RoamIdle
+	float Health = 100.0f;
+	FVector RoamTarget = FVector::ZeroVector;
+	FVector HomeLocation = FVector::ZeroVector;	// Roam targets are picked around this so proxies don't drift off the navmesh
+	FRandomStream RandomStream;					// Per entity so chunks can be processed in parallel
+};
+
+
+// Marks entities that are background enemies
+USTRUCT()
+struct ENEMYLOCKONTARGETING_API FEnemyProxyTag : public FMassTag
+{
+	GENERATED_BODY()
+};
@@ -0,0 +1,39 @@
+/*
+* Author: Eyan Martucci
+* Description: Moves background enemies through RoamIdle and Roaming in parallel.
+*	Proxies roam in straight lines without the navmesh, they are projected onto it when promoted.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"				// For UMassProcessor
+#include "MassEntityQuery.h"			// For FMassEntityQuery
+#include "EnemyProxyProcessor.generated.h"
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UEnemyProxyProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+
+	UEnemyProxyProcessor();
+
+protected:
+
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+
+	FMassEntityQuery EntityQuery;
+
+	// Match the enemy controller and character defaults
+	float RoamRadius = 5000.0f;
+	float RoamSpeed = 450.0f;
+	float RoamBaseWaitTime = 2.0f;
+	float RoamWaitTimeRandomness = 1.0f;
+	float AcceptanceRadius = 50.0f;
+};
@@ -0,0 +1,80 @@
+/*
+* Author: Eyan Martucci
+* Description: Builds one distance field on a grid around the player so chasing enemies can steer
+*	toward them by sampling it, instead of each enemy finding and following its own path.
+*	Navmesh walkability is sampled per cell under a budget and cached, the distance field is rebuilt
+*	in full when the player enters a new cell or newly sampled cells change it.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ChaseFlowFieldSubsystem.generated.h"
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UChaseFlowFieldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Starts steering a chasing enemy with the field, returns false if it can't use the field (it should path normally)
+	bool AddChaser(class AEnemyAIController* Controller);
+	void RemoveChaser(class AEnemyAIController* Controller);
+	bool IsChaser(const class AEnemyAIController* Controller) const;
+
+	// Gets the 2D direction to move in from Location to reach Target, false if Target isn't the field's goal
+	//	or Location isn't connected to it inside the field
+	bool GetChaseDirection(const FVector& Location, const AActor* Target, FVector& OutDirection) const;
+
+	static bool IsEnabled();			// LockOn.UseChaseFlowField
+
+private:
+
+	UPROPERTY()
+	AActor* GoalActor = nullptr;				// The field leads to this actor (the player)
+
+	TArray<TWeakObjectPtr<class AEnemyAIController>> Chasers;	// Enemies steered by the field every frame
+	float ChaseAcceptanceRadius = 100.0f;		// Chasers start attacking this close to the goal (plus both collision radii)
+
+	// *** Field
+	TArray<float> Costs;						// Path distance to the goal cell for every field cell (MAX_flt if unreachable)
+	FIntPoint FieldMin = FIntPoint::ZeroValue;	// World cell coordinate of the field's first cell
+	FIntPoint GoalCell = FIntPoint::ZeroValue;
+	bool bHasField = false;
+	bool bFieldDirty = false;					// Newly sampled cells are inside the field
+	float TimeSinceRebuild = 0.0f;
+
+	// *** Navmesh Sampling Cache (field sized ring buffer indexed by world cell modulo the field width, so cells
+	//	still inside the field after it moves keep their samples and cells that left it are overwritten)
+	TArray<float> SampledHeights;				// Navmesh height of each sampled cell, NAN if it isn't walkable
+	TArray<FIntPoint> SampledCells;				// World cell each slot was sampled for
+	TArray<float> FieldHeights;					// Sampled heights in field order, copied before each rebuild (NAN if not walkable)
+	int32 SampleRing = 0;						// Rings around the goal cell closer than this are fully sampled
+
+	float CellSize = 100.0f;
+	int32 FieldHalfCells = 40;					// Field is (2 * FieldHalfCells + 1) cells wide
+	float MaxStepHeight = 75.0f;				// Neighbouring cells with a bigger height difference aren't connected
+	float MinRebuildInterval = 0.1f;
+
+	int32 GetFieldWidth() const { return FieldHalfCells * 2 + 1; }
+
+	FIntPoint GetCellCoord(const FVector& Location) const {
+		return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize)); }
+
+	// Returns the field index of a world cell, INDEX_NONE if it's outside the field
+	int32 GetFieldIndex(const FIntPoint& Cell) const;
+
+	int32 GetSampleSlot(const FIntPoint& Cell) const;		// Ring buffer slot of a world cell
+	float GetSampledHeight(const FIntPoint& Cell) const;	// NAN if the cell isn't walkable or hasn't been sampled
+
+	void SteerChasers();							// Moves every chaser along the field, hands back arrived and lost chasers
+	void SampleCells(const FVector& GoalLocation);	// Projects unsampled field cells onto the navmesh within the budget
+	void RebuildField();							// Dijkstra from the goal cell over the field heights
+	bool AreCellsConnected(const FIntPoint& From, const FIntPoint& To) const;
+};
@@ -0,0 +1,43 @@
+/*
+* Author: Eyan Martucci
+* Description: Opt in deterministic simulation for reproducible benchmark and soak runs. The engine
+*	advances with a fixed delta time as fast as it can (no frame rate cap), the global random seed is
+*	fixed, and every enemy gets its own seeded random stream.
+*	Enable with -LockOnDeterministic [-LockOnSeed=1337] [-LockOnFixedFps=60] or LockOn.DeterministicSim 1 before loading a level.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DeterministicSimSubsystem.generated.h"
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UDeterministicSimSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;		// Before level actors are possessed
+	virtual void Deinitialize() override;
+
+	// Seeded from the simulation seed in creation order when deterministic, randomly seeded otherwise
+	FRandomStream CreateRandomStream();
+
+	uint32 GetSeed() const { return Seed; }
+	float GetFixedDeltaTime() const { return FixedDeltaTime; }
+
+	static bool IsEnabled();		// True while a deterministic world is running
+
+private:
+
+	uint32 Seed = 1337;
+	uint32 NextStreamIndex = 0;
+	float FixedDeltaTime = 1.0f / 60.0f;
+
+	bool bAppliedFixedTimeStep = false;		// Restore the engine settings below when the world ends
+	bool bPreviousUseFixedTimeStep = false;
+	double PreviousFixedDeltaTime = 0.0;
+};
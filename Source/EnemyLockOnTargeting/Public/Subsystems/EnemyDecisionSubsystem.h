@@ -0,0 +1,87 @@
+/*
+* Author: Eyan Martucci
+* Description: Packed per enemy decision state updated with ParallelFor. Only enemies with work (retreating
+*	or with a decision timer running) are in the active list. Their locations are gathered on the game thread,
+*	state timers and retreat destinations are computed on worker threads, and the results are applied on
+*	the game thread in a fixed order (state switches, move requests and montage starts).
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Controllers/EnemyAIController.h"		// For EEnemyState
+#include "EnemyDecisionSubsystem.generated.h"
+
+
+// Everything a decision update reads, plain data so it can be updated off the game thread
+struct FEnemyDecisionState
+{
+	FVector PawnLocation = FVector::ZeroVector;		// Gathered every frame while active
+	FVector TargetLocation = FVector::ZeroVector;	// Gathered every frame while active
+	float Timer = 0.0f;								// Used by LockOn.EnemyStateTimerMode 3
+	float RetreatDistance = 600.0f;
+	float MoveInterval = 0.0f;						// The controller's tick LOD interval, retreat moves are requested this often
+	float TimeSinceMove = 0.0f;
+	EEnemyState State = EEnemyState::RoamIdle;
+	EEnemyState TimerNextState = EEnemyState::RoamIdle;
+	bool bTimerActive = false;
+	bool bHasTarget = false;
+};
+
+
+// What the game thread has to do for an enemy after the parallel update
+struct FEnemyDecisionResult
+{
+	FVector MoveDestination = FVector::ZeroVector;
+	EEnemyState NextState = EEnemyState::RoamIdle;
+	bool bSwitchState = false;		// The state timer expired
+	bool bMove = false;				// Move to MoveDestination
+};
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UEnemyDecisionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	uint32 RegisterEnemy(class AEnemyAIController* Controller, float RetreatDistance);	// Returns the id used below
+	void UnregisterEnemy(uint32 Id);
+
+	void SetState(uint32 Id, EEnemyState NewState);
+	void StartTimer(uint32 Id, float Duration, EEnemyState NextState);
+	void ClearTimer(uint32 Id);
+
+	int32 GetNumEnemies() const { return States.Num(); }
+	int32 GetNumActiveEnemies() const { return ActiveIndices.Num(); }
+
+	static bool IsEnabled();		// LockOn.UseEnemyDecisionArray
+
+private:
+
+	// *** Enemies (same index in every array)
+	TArray<TWeakObjectPtr<class AEnemyAIController>> Controllers;
+	TArray<uint32> EnemyIds;
+	TArray<FEnemyDecisionState> States;
+	TArray<FEnemyDecisionResult> Results;
+	TMap<uint32, int32> IdToIndex;
+	TArray<int32> ActiveSlots;			// Position of each enemy in ActiveIndices, INDEX_NONE while it has nothing to update
+
+	// *** Active Enemies (retreating or with a timer running, the only ones gathered and updated)
+	TArray<int32> ActiveIndices;
+
+	uint32 NextEnemyId = 1;
+
+	void RemoveEnemyAtSwap(int32 Index);
+	void UpdateActive(int32 Index, bool bForceInactive = false);		// Adds or removes an enemy from the active list
+	void GatherLocations();
+	void UpdateDecisions(float DeltaTime);		// Runs on worker threads
+	void ApplyResults();
+
+	static void UpdateDecision(FEnemyDecisionState& State, FEnemyDecisionResult& Result, float DeltaTime);
+};
@@ -0,0 +1,83 @@
+/*
+* Author: Eyan Martucci
+* Description: Shared sight perception for enemies. The player is the only stimulus source, so every
+*	frame all enemies are tested against the player with a 4 wide radius and cone prefilter, and
+*	only the enemies that pass get an async line of sight trace (within a per frame trace budget).
+*	Gained and lost sight events are sent to the controllers like the perception component did.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"					// For FTraceDelegate and FTraceDatum
+#include "EnemyPerceptionSubsystem.generated.h"
+
+
+// Sight settings of a listener, matches UAISenseConfig_Sight
+struct FEnemySightConfig
+{
+	float SightRadius = 2000.0f;
+	float LoseSightRadius = 2500.0f;			// Used instead of SightRadius while the player is visible
+	float PeripheralVisionAngleDegrees = 90.0f;	// Half angle of the view cone
+	float TimeUntilLosingSight = 2.0f;			// The player stays sensed this long after sight is lost
+};
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UEnemyPerceptionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterListener(class AEnemyAIController* Controller, const FEnemySightConfig& Config);
+	void UnregisterListener(class AEnemyAIController* Controller);
+
+	// Compares a perception component event with this listener's current sight (LockOn.ValidateSharedPerception)
+	void ValidateComponentEvent(class AEnemyAIController* Controller, bool bComponentSensed);
+
+	static bool IsEnabled();				// LockOn.UseSharedPerception
+	static bool IsValidating();				// LockOn.ValidateSharedPerception
+
+private:
+
+	// *** Listeners (structure of arrays, same index in every array)
+	TArray<TWeakObjectPtr<class AEnemyAIController>> Controllers;
+	TArray<uint32> ListenerIds;				// Stable id sent with each async trace
+	TMap<uint32, int32> IdToIndex;
+	TArray<FEnemySightConfig> Configs;
+
+	// Refreshed every frame before the prefilter
+	TArray<float> EyeX, EyeY, EyeZ;
+	TArray<float> ForwardX, ForwardY, ForwardZ;
+	TArray<float> RadiusSqr;				// Sight or lose sight radius squared
+	TArray<float> CosHalfAngle;
+
+	// Sight state
+	TArray<bool> bInCone;					// Passed the radius and cone prefilter this frame
+	TArray<bool> bTraceVisible;				// Result of the last line of sight trace
+	TArray<bool> bTracePending;
+	TArray<bool> bDiscardTrace;				// Pending trace was issued before leaving the cone, its result is ignored
+	TArray<double> LastTraceTime;
+	TArray<bool> bVisible;					// In the cone with a clear trace
+	TArray<double> LastVisibleChangeTime;
+	TArray<bool> bSensed;					// Reported to the controller (stays true until TimeUntilLosingSight passes)
+	TArray<double> LastSeenTime;
+
+	uint32 NextListenerId = 1;
+	FTraceDelegate SightTraceDelegate;
+
+	int32 NumValidationMatches = 0;
+	int32 NumValidationMismatches = 0;
+
+	void RemoveListenerAtSwap(int32 Index);
+	void GatherListenerViews(const FVector& PlayerLocation);
+	void RunPrefilter(const FVector& PlayerLocation);			// 4 listeners at a time
+	void IssueSightTraces(AActor* Player);
+	void OnSightTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum);
+};
@@ -0,0 +1,53 @@
+/*
+* Author: Eyan Martucci
+* Description: Keeps dead and despawned enemies hidden in a pool and reuses them for new spawns,
+*	so spawning skips actor construction, component registration, AI possession and widget creation.
+*	Spawn times go into histograms, compare LockOn.UseEnemyPool 0 and 1 with LockOn.DumpEnemySpawnHistograms.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ProfilingDebugging/Histogram.h"		// For FHistogram
+#include "EnemyPoolSubsystem.generated.h"
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UEnemyPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// Spawns enemies straight into the pool (called at level load)
+	void Prewarm(TSubclassOf<class AEnemyCharacter> EnemyClass, int32 Count, const FVector& Location);
+
+	// Reuses a pooled enemy of the class when there is one, otherwise spawns a new one
+	class AEnemyCharacter* AcquireEnemy(TSubclassOf<class AEnemyCharacter> EnemyClass, const FVector& Location, const FRotator& Rotation);
+
+	// Hides the enemy in the pool, or destroys it when pooling is off or the pool is full
+	void ReleaseEnemy(class AEnemyCharacter* Enemy);
+
+	const FHistogram& GetSpawnActorHistogram() const { return SpawnActorHistogram; }
+	const FHistogram& GetPooledHistogram() const { return PooledHistogram; }
+	int32 GetNumFree() const { return FreeEnemies.Num(); }
+
+	void ResetHistograms();
+	void DumpHistograms();
+
+	static bool IsEnabled();		// LockOn.UseEnemyPool
+
+private:
+
+	UPROPERTY()
+	TArray<class AEnemyCharacter*> FreeEnemies;
+
+	FHistogram SpawnActorHistogram;		// Spawn times in ms when a new actor had to be spawned
+	FHistogram PooledHistogram;			// Spawn times in ms when a pooled enemy was reused
+
+	class AEnemyCharacter* SpawnNewEnemy(TSubclassOf<class AEnemyCharacter> EnemyClass, const FVector& Location, const FRotator& Rotation,
+		ESpawnActorCollisionHandlingMethod CollisionHandling = ESpawnActorCollisionHandlingMethod::Undefined) const;
+};
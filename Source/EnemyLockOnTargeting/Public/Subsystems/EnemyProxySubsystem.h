@@ -0,0 +1,61 @@
+/*
+* Author: Eyan Martucci
+* Description: Swaps enemies between full AEnemyCharacter actors near the player and lightweight
+*	Mass entities (see UEnemyProxyProcessor) further away. Promotion and demotion use two radii
+*	so enemies at the edge don't swap back and forth, and are limited per update to avoid spawn hitches.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MassEntityTypes.h"				// For FMassEntityHandle
+#include "MassArchetypeTypes.h"			// For FMassArchetypeHandle
+#include "EnemyProxySubsystem.generated.h"
+
+struct FMassEntityManager;
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UEnemyProxySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterEnemy(class AEnemyCharacter* Enemy);		// Called on BeginPlay, the enemy can be demoted when far away
+	void UnregisterEnemy(class AEnemyCharacter* Enemy);		// Called on EndPlay
+
+	// Creates background enemies at random points in a circle (LockOn.SpawnEnemyProxies)
+	void SpawnProxies(int32 Count, const FVector& Center, float Radius);
+
+	int32 GetNumProxies() const { return ProxyHandles.Num(); }
+	int32 GetNumActors() const { return ActiveEnemies.Num(); }
+
+	static bool IsEnabled();			// LockOn.UseEnemyProxies
+
+	void SetDemotionPaused(bool bPaused) { bDemotionPaused = bPaused; }	// Keeps every actor an actor, proxies still promote
+
+private:
+
+	UPROPERTY()
+	TArray<class AEnemyCharacter*> ActiveEnemies;	// Enemies that currently exist as actors
+
+	TArray<FMassEntityHandle> ProxyHandles;		// Enemies that currently exist as Mass entities
+	FMassArchetypeHandle ProxyArchetype;
+	FRandomStream ProxyStream;					// Seeds each proxy's own random stream
+
+	float UpdateTimer = 0.0f;					// Counts down LockOn.EnemyProxyUpdateInterval
+	bool bDemotionPaused = false;				// Set while the crowd benchmark runs so its enemy count holds
+
+	FMassEntityManager* GetEntityManager() const;
+	bool EnsureArchetype();
+	FMassEntityHandle CreateProxy(FMassEntityManager& EntityManager, const FVector& Location, const FRotator& Rotation,
+		float Health, float IdleTime);
+
+	void PromoteNearbyProxies(FMassEntityManager& EntityManager, const FVector& PlayerLocation, float PromoteRadius, int32 MaxSwaps);
+	void DemoteDistantEnemies(FMassEntityManager& EntityManager, const FVector& PlayerLocation, float DemoteRadius, int32 MaxSwaps);
+};
@@ -0,0 +1,55 @@
+/*
+* Author: Eyan Martucci
+* Description: Shared timer wheel for enemy state transitions. Idle and retreat countdowns are
+*	scheduled here instead of ticking every controller, expired timers are fired in one batch.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Subsystems/TimerWheel.h"				// For TTimerWheel
+#include "Controllers/EnemyAIController.h"		// For EEnemyState
+#include "EnemyStateTimerSubsystem.generated.h"
+
+
+// How pending enemy state timers are counted down (LockOn.EnemyStateTimerMode)
+enum class EEnemyStateTimerMode : uint8
+{
+	ActorTick,		// Each controller ticks and decrements its own timer
+	TimerManager,	// Each controller sets a timer on the world timer manager
+	TimerWheel,		// Timers are scheduled in the shared UEnemyStateTimerSubsystem wheel
+	DecisionArray,	// Timers are counted down with the other decisions in UEnemyDecisionSubsystem
+};
+
+
+// Timer wheel payload, the controller switches to NextState when it expires
+struct FEnemyStateTimer
+{
+	TWeakObjectPtr<AEnemyAIController> Controller;
+	EEnemyState NextState = EEnemyState::RoamIdle;
+};
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UEnemyStateTimerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	FTimerWheelHandle ScheduleStateTimer(AEnemyAIController* Controller, float Delay, EEnemyState NextState);
+	void CancelStateTimer(FTimerWheelHandle& Handle);
+
+	int32 GetNumPendingTimers() const { return TimerWheel.GetNumActive(); }
+
+	static EEnemyStateTimerMode GetTimerMode();		// Current LockOn.EnemyStateTimerMode
+
+private:
+
+	TTimerWheel<FEnemyStateTimer> TimerWheel;
+	TArray<FEnemyStateTimer> ExpiredTimers;		// Reused every tick to collect the expired batch
+};
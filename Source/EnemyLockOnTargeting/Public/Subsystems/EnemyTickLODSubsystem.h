@@ -0,0 +1,50 @@
+/*
+* Author: Eyan Martucci
+* Description: Uses the significance manager to bucket enemies by distance to the player camera
+*	and whether they are on screen, then lowers the tick rate of far or hidden enemies.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyTickLODSubsystem.generated.h"
+
+// Tick level of detail for an enemy, higher is more significant
+UENUM(BlueprintType)
+enum class EEnemyTickLOD : uint8
+{
+	Low		UMETA(DisplayName = "Low"),
+	Medium	UMETA(DisplayName = "Medium"),
+	High	UMETA(DisplayName = "High"),
+};
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UEnemyTickLODSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterEnemy(class AEnemyCharacter* Enemy);		// Starts managing an enemy's tick rate
+	void UnregisterEnemy(class AEnemyCharacter* Enemy);		// Stops managing an enemy's tick rate
+
+	float GetTickInterval(EEnemyTickLOD LOD) const;			// Tick interval used for enemies at this LOD
+
+private:
+
+	float HighLODDistance = 3000.0f;		// Enemies closer than this tick every frame
+	float MediumLODDistance = 8000.0f;		// Enemies closer than this tick at the medium interval
+	float AlwaysHighDistance = 1500.0f;		// Enemies closer than this tick every frame even when off screen
+	float MediumTickInterval = 0.1f;
+	float LowTickInterval = 0.3f;
+
+	FTransform Viewpoint;					// Player camera transform used for the last update
+	float CosHalfFOV = 0.5f;				// Cosine of half the camera FOV for the on screen check
+
+	float CalculateSignificance(const UObject* Object, const FTransform& InViewpoint) const;
+};
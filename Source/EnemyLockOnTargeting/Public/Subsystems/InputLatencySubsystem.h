@@ -0,0 +1,63 @@
+/*
+* Author: Eyan Martucci
+* Description: Measures how many frames pass between the lock on input and the first frame each system
+*	acts on it (camera, targeting arrow and player rotation). Percentiles go to the stat group and CSV,
+*	LockOn.DumpInputLatency logs them and writes every sample to Saved/Benchmarks.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "InputLatencySubsystem.generated.h"
+
+
+// Systems that react to the lock on input
+enum class ELockOnLatencyConsumer : uint8
+{
+	TargetingCamera,	// ULockOnTargeting moved the spring arm or control rotation
+	TargetingArrow,		// ATargetingArrow moved to the new target
+	PlayerRotation,		// APlayerCharacter rotated toward the target
+	Num
+};
+
+
+struct FInputLatencySample
+{
+	uint32 InputIndex = 0;
+	ELockOnLatencyConsumer Consumer = ELockOnLatencyConsumer::TargetingCamera;
+	int32 Frames = 0;		// 0 means the consumer acted in the same frame as the input
+	float Ms = 0.0f;
+};
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UInputLatencySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	void BeginInput();									// Timestamps a new lock on input
+	void MarkConsumed(ELockOnLatencyConsumer Consumer);	// Records a sample the first time the consumer acts on the input
+
+	void ResetSamples();
+	void DumpSamples();		// Logs percentiles and writes the samples to a CSV file
+
+	const TArray<FInputLatencySample>& GetSamples() const { return Samples; }
+
+	static bool IsEnabled();		// LockOn.TrackInputLatency
+
+private:
+
+	TArray<FInputLatencySample> Samples;		// Oldest samples are dropped after LockOn.InputLatencyMaxSamples
+
+	uint64 InputFrame = 0;
+	double InputTime = 0.0;
+	uint32 InputIndex = 0;
+	uint8 PendingConsumers = 0;		// Bit per consumer that hasn't acted on the input yet
+
+	void RecordSample(ELockOnLatencyConsumer Consumer, int32 Frames, float Ms);
+	void UpdatePercentileStats(ELockOnLatencyConsumer Consumer) const;
+	void GetPercentiles(ELockOnLatencyConsumer Consumer, float& P50Frames, float& P95Frames, float& P50Ms, float& P95Ms, int32& NumSamples) const;
+};
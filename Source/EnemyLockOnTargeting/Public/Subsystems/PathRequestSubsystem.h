@@ -0,0 +1,51 @@
+/*
+* Author: Eyan Martucci
+* Description: Queues enemy move requests and finds their paths asynchronously. Only a fixed number of
+*	path queries start each frame (closest to the player first), and a request is dropped when the
+*	agent is already heading to almost the same destination.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AITypes.h"						// For FAIMoveRequest
+#include "NavigationData.h"					// For FNavPathSharedPtr
+#include "PathRequestSubsystem.generated.h"
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UPathRequestSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Queues a path request for the controller, replaces its pending request if there is one
+	void RequestMove(class AEnemyAIController* Controller, const FAIMoveRequest& MoveRequest);
+	void CancelRequests(class AEnemyAIController* Controller);	// Drops the pending request and aborts the query in flight
+
+	int32 GetNumPending() const { return NumPending; }
+
+private:
+
+	struct FAgentPathState
+	{
+		FAIMoveRequest PendingRequest;
+		bool bPending = false;
+		uint32 QueryId = INVALID_NAVQUERYID;		// Async query in flight, results from older queries are ignored
+		FVector LastDestination = FVector::ZeroVector;		// Destination of the last issued request
+		bool bHasDestination = false;
+	};
+
+	TMap<TWeakObjectPtr<class AEnemyAIController>, FAgentPathState> AgentStates;
+	int32 NumPending = 0;
+
+	void OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path,
+		TWeakObjectPtr<class AEnemyAIController> Controller, FAIMoveRequest MoveRequest);
+
+	static FVector GetRequestDestination(const FAIMoveRequest& MoveRequest);
+};
@@ -0,0 +1,68 @@
+/*
+* Author: Eyan Martucci
+* Description: Caches pools of reachable roam destinations per navmesh region. Pools are refilled
+*	a few points at a time under a per frame time budget, so enemies that start roaming on the
+*	same frame take a point from a pool in O(1) instead of each running a navmesh query.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RoamPointSubsystem.generated.h"
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API URoamPointSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Gets a reachable point within roughly the roam radius of Origin, runs a navmesh query if the region's pool is empty
+	bool GetRoamPoint(const FVector& Origin, FVector& OutPoint);
+
+	void PrewarmRegion(const FVector& Origin);		// Queues the region containing Origin for filling (called when an enemy spawns)
+	void SetRoamRadius(float NewRoamRadius);		// Clears every pool if the radius changes
+
+	float GetHitRate() const { return NumRequests > 0 ? (float)NumHits / NumRequests : 0.0f; }
+
+private:
+
+	// Cached points for one region, handed out from the back of the array
+	struct FRoamPointPool
+	{
+		TArray<FVector> Points;
+		FVector SampleOrigin = FVector::ZeroVector;		// Navigable location points are sampled around
+		bool bHasSampleOrigin = false;
+		bool bQueuedForRefill = false;
+	};
+
+	TMap<FIntPoint, FRoamPointPool> Pools;
+	TArray<FIntPoint> RefillQueue;				// Regions below the low water mark, refilled in order
+
+	float RoamRadius = 5000.0f;					// Matches the enemy controller's roam radius
+	int32 PoolSize = 32;						// Points kept per region
+	int32 LowWaterMark = 8;						// Region is queued for refill when it has fewer points than this
+
+	// *** Stats
+	int64 NumRequests = 0;
+	int64 NumHits = 0;
+	double FrameQueryMs = 0.0;					// Time spent in navmesh queries this frame (refills and misses)
+	double WorstFrameQueryMs = 0.0;
+
+	// Regions are half the roam radius wide and points are sampled close enough to the region's
+	// sample origin that any enemy inside the region stays within about one roam radius of them
+	float GetRegionSize() const { return RoamRadius * 0.5f; }
+	float GetSampleRadius() const { return RoamRadius - GetRegionSize() * UE_HALF_SQRT_2; }
+
+	FIntPoint GetRegionCoord(const FVector& Location) const {
+		return FIntPoint(FMath::FloorToInt32(Location.X / GetRegionSize()), FMath::FloorToInt32(Location.Y / GetRegionSize())); }
+
+	FRoamPointPool& FindOrAddPool(const FIntPoint& Region, const FVector& Origin);
+	void QueueRefill(const FIntPoint& Region, FRoamPointPool& Pool);
+	bool QueryRoamPoint(const FRoamPointPool& Pool, FVector& OutPoint);	// Runs one timed navmesh query
+};
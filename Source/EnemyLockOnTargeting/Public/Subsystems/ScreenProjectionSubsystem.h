@@ -0,0 +1,102 @@
+/*
+* Author: Eyan Martucci
+* Description: Projects every registered target to the screen once per frame, after the camera update,
+*	four at a time with the view projection matrix. Lock on target scoring and enemy healthbar culling
+*	read the cached screen position, depth and on screen flag instead of each doing camera math.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"		// For FTickFunction
+#include "ScreenProjectionSubsystem.generated.h"
+
+
+// Runs the projection in TG_PostUpdateWork, after the player controller has updated the camera
+USTRUCT()
+struct FScreenProjectionTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UScreenProjectionSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+		const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override { return TEXT("UScreenProjectionSubsystem::UpdateProjections"); }
+	virtual FName DiagnosticContext(bool bDetailed) override { return FName(TEXT("ScreenProjection")); }
+};
+
+template<>
+struct TStructOpsTypeTraits<FScreenProjectionTickFunction> : public TStructOpsTypeTraitsBase2<FScreenProjectionTickFunction>
+{
+	enum { WithCopy = false };
+};
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UScreenProjectionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	void UpdateProjections();		// Called by the tick function
+
+	// Screen position in normalized device coordinates (-1..1, +Y up) and view depth.
+	//	Actors registered since the last update are projected on the spot. Returns false when behind the camera.
+	bool GetScreenPosition(AActor* Actor, FVector2f& OutScreenPosition, float* OutDepth = nullptr) const;
+
+	bool IsOnScreen(AActor* Actor) const;		// True if cached as on screen (or not cached yet)
+
+	bool HasView() const { return bHasView; }
+	const FVector& GetViewLocation() const { return ViewLocation; }		// Camera location used by the last update
+	FTickFunction& GetTickFunction() { return TickFunction; }			// Consumers in TG_PostUpdateWork tick after this
+
+	static bool IsEnabled();		// LockOn.UseScreenProjectionCache
+
+	// Hides a component (e.g. a screen space healthbar) while its registered owner is off screen.
+	//	Visibility only changes when the owner crosses the screen edge, unregistering shows it again.
+	void RegisterCulledComponent(AActor* Owner, USceneComponent* Component);
+	void UnregisterCulledComponent(AActor* Owner);
+
+private:
+
+	FScreenProjectionTickFunction TickFunction;
+
+	UPROPERTY()
+	class UTargetableRegistry* TargetableRegistry = nullptr;
+
+	// *** Projections (same index as the registry at the last update, screen arrays padded to a multiple of 4)
+	TArray<AActor*> ProjectedActors;		// Only compared against, never dereferenced
+	TArray<float> ScreenX;
+	TArray<float> ScreenY;
+	TArray<float> Depths;
+	TArray<uint8> OnScreenFlags;
+
+	// *** Scratch Copies of the Registry Locations Relative to the Camera
+	TArray<float> RelativeX;
+	TArray<float> RelativeY;
+	TArray<float> RelativeZ;
+
+	// *** Components Culled Off Screen
+	struct FCulledComponent
+	{
+		TWeakObjectPtr<AActor> Owner;
+		TWeakObjectPtr<USceneComponent> Component;
+		bool bVisible = true;
+	};
+	TArray<FCulledComponent> CulledComponents;
+
+	FMatrix44f ViewProjection = FMatrix44f::Identity;	// Camera at the origin, locations are made relative first
+	FVector ViewLocation = FVector::ZeroVector;
+	bool bHasView = false;
+
+	int32 FindProjectionIndex(AActor* Actor) const;
+	void UpdateCulledComponents();
+	static void SetCulledVisibility(FCulledComponent& Culled, bool bVisible);
+	bool ProjectRelative(const FVector3f& Relative, FVector2f& OutScreenPosition, float& OutDepth) const;
+};
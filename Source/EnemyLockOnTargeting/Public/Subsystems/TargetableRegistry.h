@@ -0,0 +1,97 @@
+/*
+* Author: Eyan Martucci
+* Description: World subsystem that stores every targetable actor and its location
+*	so targeting queries don't need a physics overlap or a tag interface lookup.
+*	Actors are also bucketed into a uniform 2D hash grid so queries only visit nearby cells.
+*	Tags that queries filter on are compiled to bits, so the tag check is a single AND per candidate.
+*	Only registered actors can be targeted: enemies register themselves, other actors need a UTargetableComponent.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GameplayTagContainer.h"		// For FGameplayTag and FGameplayTagContainer
+#include "Targeting/TargetSelectionKernel.h"	// For FTargetCandidates
+#include "TargetableRegistry.generated.h"
+
+
+UCLASS()
+class ENEMYLOCKONTARGETING_API UTargetableRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	void RegisterTarget(AActor* Actor, const FGameplayTagContainer& Tags);	// Adds actor to registry (called on BeginPlay)
+	void UnregisterTarget(AActor* Actor);									// Removes actor from registry (called on EndPlay)
+	void UpdateTargetLocation(AActor* Actor, const FVector& Location);		// Stores the new location of a registered actor
+	void UpdateTargetTags(AActor* Actor, const FGameplayTagContainer& Tags);	// Recomputes the tag mask of a registered actor
+	void SetTargetThreat(AActor* Actor, float Threat);						// Read by the threat selection policy
+
+	// Returns the query bit of the tag, assigning one the first time a tag is queried on (0 if invalid or out of bits)
+	uint64 GetTagQueryMask(const FGameplayTag& Tag);
+
+	// Adds every registered actor that has all RequiredTagMask bits inside the sphere (and its location) to OutTargets
+	void QueryTargetsInSphere(const FVector& Center, float Radius, uint64 RequiredTagMask,
+		const TArray<AActor*>& ActorsToIgnore, FTargetCandidates& OutTargets) const;
+
+	void SetGridCellSize(float NewCellSize);		// Rebuilds the grid with a new cell size (should match the query diameter)
+
+	// Returns a value that changes whenever a target enters, leaves or noticeably moves in the cells covered by the sphere
+	uint32 GetRegionVersion(const FVector& Center, float Radius) const;
+
+	int32 GetNumTargets() const { return Actors.Num(); }
+	bool IsRegistered(AActor* Actor) const { return ActorToIndex.Contains(Actor); }
+
+	// Packed arrays for batch consumers, indices stay valid until the next register or unregister
+	int32 GetTargetIndex(AActor* Actor) const { const int32* index = ActorToIndex.Find(Actor); return index ? *index : INDEX_NONE; }
+	TConstArrayView<AActor*> GetTargetActors() const { return Actors; }
+	TConstArrayView<float> GetLocationsX() const { return LocationsX; }
+	TConstArrayView<float> GetLocationsY() const { return LocationsY; }
+	TConstArrayView<float> GetLocationsZ() const { return LocationsZ; }
+
+private:
+
+	UPROPERTY()
+	TArray<AActor*> Actors;						// Registered actors, same index as the location arrays
+
+	// Locations stored as separate contiguous arrays so queries only touch plain floats
+	TArray<float> LocationsX;
+	TArray<float> LocationsY;
+	TArray<float> LocationsZ;
+
+	TArray<uint64> TargetTagMasks;				// Query bits of each actor's tags, checked by queries
+	TArray<float> TargetThreats;				// Copied into query results for the threat selection policy
+	TArray<FGameplayTagContainer> TargetTags;	// Copy of each actor's tags, only read when masks are recomputed
+	TArray<FGameplayTag> QueryTags;				// Tags that have a query bit, the array index is the bit
+	TMap<AActor*, int32> ActorToIndex;			// Finds the array index of a registered actor
+
+	// Spatial hash grid
+	TMap<FIntPoint, TArray<int32>> GridCells;	// Registry indices of the actors inside each cell
+	TArray<FIntPoint> TargetCells;				// The cell each registered actor is currently in
+	TArray<FVector> StampedLocations;			// Location of each actor when its cell version was last bumped
+	TMap<FIntPoint, uint32> CellVersions;		// Bumped whenever a cell's contents change or move
+	float GridCellSize = 2500.0f;				// Width of a grid cell (matches default MaxTargetingDistance)
+
+	void RemoveTargetAtSwap(int32 Index);		// Removes entry by swapping the last entry into its place
+	void AddToCell(int32 Index, const FIntPoint& Cell);
+	void RemoveFromCell(int32 Index, const FIntPoint& Cell);
+	void BumpCellVersion(const FIntPoint& Cell) { CellVersions.FindOrAdd(Cell)++; }
+
+	FIntPoint GetCellCoord(float X, float Y) const {
+		return FIntPoint(FMath::FloorToInt32(X / GridCellSize), FMath::FloorToInt32(Y / GridCellSize)); }
+
+	uint64 ComputeTagMask(const FGameplayTagContainer& Tags) const;	// Sets the bit of every query tag the container has
+
+	// Returns true if the entry is inside the sphere, has the tag bits and isn't ignored
+	bool IsValidTargetInSphere(int32 Index, const FVector& Center, float RadiusSqr,
+		uint64 RequiredTagMask, const TArray<AActor*>& ActorsToIgnore) const;
+
+	// Brute force version of QueryTargetsInSphere used when the grid is disabled or being validated
+	void QueryTargetsInSphereLinear(const FVector& Center, float Radius, uint64 RequiredTagMask,
+		const TArray<AActor*>& ActorsToIgnore, FTargetCandidates& OutTargets) const;
+
+	void AddCandidate(int32 Index, FTargetCandidates& OutTargets) const {
+		OutTargets.Add(Actors[Index], LocationsX[Index], LocationsY[Index], LocationsZ[Index], TargetThreats[Index]); }
+};
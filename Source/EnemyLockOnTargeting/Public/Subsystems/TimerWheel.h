@@ -0,0 +1,168 @@
+/*
+* Author: Eyan Martucci
+* Description: Two level hierarchical timer wheel. Scheduling and cancelling are O(1) and
+*	advancing only touches timers that expire (plus one cascade bucket every 256 ticks).
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+// Identifies a scheduled timer, stale handles are ignored when cancelled
+struct FTimerWheelHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Generation = 0;
+
+	bool IsSet() const { return Index != INDEX_NONE; }
+	void Invalidate() { Index = INDEX_NONE; }
+};
+
+
+template<typename PayloadType>
+class TTimerWheel
+{
+public:
+
+	static constexpr int32 NearSlots = 256;		// Level 0 covers NearSlots ticks
+	static constexpr int32 FarSlots = 64;		// Level 1 covers NearSlots * FarSlots ticks
+
+	explicit TTimerWheel(float InTickResolution = 1.0f / 30.0f)
+		: TickResolution(InTickResolution)
+	{
+		NearWheel.SetNum(NearSlots);
+		FarWheel.SetNum(FarSlots);
+	}
+
+	// Schedules Payload to expire after Delay seconds (at least one tick)
+	FTimerWheelHandle Schedule(float Delay, const PayloadType& Payload) {
+
+		const uint64 ticks = FMath::Clamp<uint64>(FMath::CeilToInt64(Delay / TickResolution), 1, (uint64)NearSlots * FarSlots - 1);
+
+		// *** Reuse a Free Entry
+		int32 index;
+		if (FreeEntries.Num() > 0) {
+			index = FreeEntries.Pop(EAllowShrinking::No);
+		}
+		else {
+			index = Entries.AddDefaulted();
+		}
+
+		FEntry& entry = Entries[index];
+		entry.ExpireTick = CurrentTick + ticks;
+		entry.Payload = Payload;
+		entry.bActive = true;
+
+		InsertEntry(index);
+		NumActive++;
+
+		return FTimerWheelHandle{ index, entry.Generation };
+	}
+
+	// Cancels a timer, the entry is skipped when its bucket is reached
+	void Cancel(FTimerWheelHandle& Handle) {
+
+		if (Handle.IsSet() && Entries.IsValidIndex(Handle.Index)) {
+			FEntry& entry = Entries[Handle.Index];
+
+			if (entry.bActive && entry.Generation == Handle.Generation) {
+				entry.bActive = false;
+				NumActive--;
+			}
+		}
+
+		Handle.Invalidate();
+	}
+
+	// Advances time and appends the payload of every expired timer to OutExpired
+	template<typename AllocatorType>
+	void Advance(float DeltaTime, TArray<PayloadType, AllocatorType>& OutExpired) {
+
+		Accumulator += DeltaTime;
+
+		while (Accumulator >= TickResolution) {
+			Accumulator -= TickResolution;
+			CurrentTick++;
+
+			// *** Move the Next Far Bucket Into the Near Wheel Once Per Rotation
+			if ((CurrentTick % NearSlots) == 0)
+				CascadeFarBucket();
+
+			// *** Fire Every Timer in the Current Near Bucket
+			TArray<int32>& bucket = NearWheel[CurrentTick % NearSlots];
+			for (int32 index : bucket)
+				ExpireEntry(index, OutExpired);
+			bucket.Reset();
+		}
+	}
+
+	int32 GetNumActive() const { return NumActive; }
+
+private:
+
+	struct FEntry
+	{
+		uint64 ExpireTick = 0;
+		uint32 Generation = 0;
+		bool bActive = false;
+		PayloadType Payload;
+	};
+
+	TArray<FEntry> Entries;
+	TArray<int32> FreeEntries;
+	TArray<TArray<int32>> NearWheel;
+	TArray<TArray<int32>> FarWheel;
+
+	float TickResolution;
+	float Accumulator = 0.0f;
+	uint64 CurrentTick = 0;
+	int32 NumActive = 0;
+
+	// Places an entry in the near wheel if it expires within one rotation, otherwise the far wheel
+	void InsertEntry(int32 Index) {
+
+		const uint64 expireTick = Entries[Index].ExpireTick;
+
+		if (expireTick - CurrentTick < NearSlots)
+			NearWheel[expireTick % NearSlots].Add(Index);
+		else
+			FarWheel[(expireTick / NearSlots) % FarSlots].Add(Index);
+	}
+
+	// Re-inserts entries from the far bucket that is now within one near rotation
+	void CascadeFarBucket() {
+
+		TArray<int32>& farBucket = FarWheel[(CurrentTick / NearSlots) % FarSlots];
+		TArray<int32, TInlineAllocator<32>> pending;
+
+		for (int32 index : farBucket) {
+			if (Entries[index].bActive)
+				pending.Add(index);
+			else
+				FreeEntry(index);
+		}
+		farBucket.Reset();
+
+		for (int32 index : pending)
+			InsertEntry(index);
+	}
+
+	template<typename AllocatorType>
+	void ExpireEntry(int32 Index, TArray<PayloadType, AllocatorType>& OutExpired) {
+
+		if (Entries[Index].bActive) {
+			OutExpired.Add(Entries[Index].Payload);
+			NumActive--;
+		}
+		FreeEntry(Index);
+	}
+
+	void FreeEntry(int32 Index) {
+
+		FEntry& entry = Entries[Index];
+		entry.bActive = false;
+		entry.Generation++;			// Stale handles no longer match
+		FreeEntries.Add(Index);
+	}
+};
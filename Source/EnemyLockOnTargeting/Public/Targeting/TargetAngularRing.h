@@ -0,0 +1,43 @@
+/*
+* Author: Eyan Martucci
+* Description: Lock on candidates sorted by yaw around the player, measured from the camera direction.
+*	Rebuilt from each selection query and re-sorted incrementally in between, so switching left or right
+*	is a binary search for the neighboring yaw, optionally wrapping around behind the camera.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FTargetCandidates;
+
+
+class ENEMYLOCKONTARGETING_API FTargetAngularRing
+{
+public:
+
+	// Replaces the ring with the gathered candidates
+	void Rebuild(const FTargetCandidates& Candidates, const FVector& Origin, float ReferenceYaw);
+
+	// Recomputes every yaw and restores the order with an insertion sort (actors move little between frames).
+	//	Actors the predicate returns false for are dropped.
+	void UpdateYaws(const FVector& Origin, float ReferenceYaw, TFunctionRef<bool(AActor*)> KeepPredicate);
+
+	// Returns the next actor to the right (larger yaw) or left of Current, null if there is none.
+	//	With bWrap the search continues from the other end of the ring.
+	AActor* FindNeighbor(const AActor* Current, bool bRight, bool bWrap) const;
+
+	int32 Num() const { return Actors.Num(); }
+	void Reset();
+
+private:
+
+	// Same index in both arrays, sorted by ascending yaw
+	TArray<TWeakObjectPtr<AActor>, TInlineAllocator<64>> Actors;
+	TArray<float, TInlineAllocator<64>> Yaws;		// Degrees relative to ReferenceYaw in (-180, 180], 0 is straight ahead
+
+	FVector LastOrigin = FVector::ZeroVector;
+	float LastReferenceYaw = 0.0f;
+
+	static float GetRelativeYaw(const FVector& Location, const FVector& Origin, float ReferenceYaw);
+};
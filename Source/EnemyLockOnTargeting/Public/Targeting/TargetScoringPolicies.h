@@ -0,0 +1,137 @@
+/*
+* Author: Eyan Martucci
+* Description: Target scoring policies composed at compile time. Each policy adds a weighted term to a
+*	candidate's score, TTargetScorer sums them in one inlined expression, and RankCandidates scores every
+*	candidate in a branch free loop before picking the best ones. Game modes pick a precompiled scorer
+*	through ULockOnTargeting::SelectionPolicy instead of paying for virtual calls per candidate.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Targeting/TargetSelectionKernel.h"	// For FTargetCandidates and FTargetSelectionResult
+
+
+// Per query values shared by every policy
+struct FTargetScoringContext
+{
+	FVector ViewLocation = FVector::ZeroVector;		// Camera location and forward, screen offsets fall back to the
+	FVector ViewForward = FVector::ForwardVector;	//	angle from these when the projection cache has no view
+	float MaxDistanceSqr = 0.0f;					// Candidates farther than this never get picked
+	float InvMaxDistanceSqr = 0.0f;					// Normalizes distance to 0..1
+
+	float DistanceWeight = 1.0f;
+	float ScreenCenterWeight = 1.0f;
+	float ThreatWeight = 1.0f;
+	float RecencyWeight = 1.0f;
+};
+
+
+namespace TargetScoring
+{
+	// Closer is better, uses the distances computed by TargetSelection::SelectTargets
+	struct FDistance
+	{
+		static constexpr bool bNeedsRecency = false;
+		static constexpr bool bNeedsScreenOffsets = false;
+
+		FORCEINLINE static float Score(const FTargetScoringContext& Context, const FTargetCandidates& Candidates, int32 Index) {
+			return -Context.DistanceWeight * Candidates.DistancesSqr[Index] * Context.InvMaxDistanceSqr;
+		}
+	};
+
+	// Closer to the middle of the screen is better (offsets read from UScreenProjectionSubsystem's cache)
+	struct FScreenCenter
+	{
+		static constexpr bool bNeedsRecency = false;
+		static constexpr bool bNeedsScreenOffsets = true;
+
+		FORCEINLINE static float Score(const FTargetScoringContext& Context, const FTargetCandidates& Candidates, int32 Index) {
+			return -Context.ScreenCenterWeight * Candidates.ScreenOffsetsSqr[Index];
+		}
+	};
+
+	// Enemies in combat with the player are better (threat registered with UTargetableRegistry)
+	struct FThreat
+	{
+		static constexpr bool bNeedsRecency = false;
+		static constexpr bool bNeedsScreenOffsets = false;
+
+		FORCEINLINE static float Score(const FTargetScoringContext& Context, const FTargetCandidates& Candidates, int32 Index) {
+			return Context.ThreatWeight * Candidates.Threats[Index];
+		}
+	};
+
+	// Targets the player locked onto recently are worse, so clearing a crowd moves through it
+	struct FRecency
+	{
+		static constexpr bool bNeedsRecency = true;
+		static constexpr bool bNeedsScreenOffsets = false;
+
+		FORCEINLINE static float Score(const FTargetScoringContext& Context, const FTargetCandidates& Candidates, int32 Index) {
+			return -Context.RecencyWeight * Candidates.Recencies[Index];
+		}
+	};
+
+
+	// Sums the policies' scores, the fold expression inlines into a single expression per candidate
+	template<typename... TPolicies>
+	struct TTargetScorer
+	{
+		static constexpr bool bNeedsRecency = (TPolicies::bNeedsRecency || ...);
+		static constexpr bool bNeedsScreenOffsets = (TPolicies::bNeedsScreenOffsets || ...);
+
+		FORCEINLINE static float Score(const FTargetScoringContext& Context, const FTargetCandidates& Candidates, int32 Index) {
+			return (TPolicies::Score(Context, Candidates, Index) + ... + 0.0f);
+		}
+	};
+
+
+	// Scores every candidate, then keeps the NumRanked best in OutResult's ranking, best and second best.
+	//	Expects DistancesSqr from TargetSelection::SelectTargets, left and right picks are left untouched.
+	template<typename TScorer>
+	void RankCandidates(FTargetCandidates& Candidates, const FTargetScoringContext& Context, int32 NumRanked, FTargetSelectionResult& OutResult)
+	{
+		const int32 numCandidates = Candidates.Num();
+		Candidates.Scores.SetNumUninitialized(numCandidates, EAllowShrinking::No);
+
+		// *** Score Without Branches (out of range candidates are selected down to -FLT_MAX)
+		for (int32 i = 0; i < numCandidates; i++) {
+			const float score = TScorer::Score(Context, Candidates, i);
+			Candidates.Scores[i] = Candidates.DistancesSqr[i] < Context.MaxDistanceSqr ? score : -FLT_MAX;
+		}
+
+		// *** Keep the Best Few, Equal Scores Keep the Earlier Candidate First
+		const int32 numRanked = FMath::Max(NumRanked, 2);
+		TArray<float, TInlineAllocator<8>> rankedScores;
+		OutResult.RankedIndices.Reset();
+
+		for (int32 i = 0; i < numCandidates; i++) {
+
+			const float score = Candidates.Scores[i];
+			if (score == -FLT_MAX) continue;
+
+			int32 rank = rankedScores.Num();
+			while (rank > 0 && score > rankedScores[rank - 1])
+				rank--;
+
+			if (rank < numRanked) {
+				if (rankedScores.Num() == numRanked) {
+					rankedScores.Pop(EAllowShrinking::No);
+					OutResult.RankedIndices.Pop(EAllowShrinking::No);
+				}
+				rankedScores.Insert(score, rank);
+				OutResult.RankedIndices.Insert(i, rank);
+			}
+		}
+
+		OutResult.NearestIndex = OutResult.RankedIndices.Num() > 0 ? OutResult.RankedIndices[0] : INDEX_NONE;
+		OutResult.SecondNearestIndex = OutResult.RankedIndices.Num() > 1 ? OutResult.RankedIndices[1] : INDEX_NONE;
+	}
+
+
+	// *** Precompiled Scorers (ETargetSelectionPolicy)
+	using FScreenCenterScorer = TTargetScorer<FDistance, FScreenCenter>;
+	using FThreatScorer = TTargetScorer<FDistance, FThreat>;
+	using FCrowdScorer = TTargetScorer<FDistance, FScreenCenter, FThreat, FRecency>;
+}
@@ -0,0 +1,99 @@
+/*
+* Author: Eyan Martucci
+* Description: Vectorized kernel that scores packed target candidates and picks the nearest,
+*	next left and next right target in a single pass.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+// Inline storage covers a typical fight, larger crowds spill to the heap once and keep that memory
+using FTargetCandidateAllocator = TInlineAllocator<64>;
+using FTargetActorArray = TArray<AActor*, FTargetCandidateAllocator>;
+using FTargetFloatArray = TArray<float, FTargetCandidateAllocator>;
+
+
+// Packed target candidates, each array uses the same index.
+//	Owners reuse one instance so steady state queries don't allocate.
+struct ENEMYLOCKONTARGETING_API FTargetCandidates
+{
+	FTargetActorArray Actors;
+	FTargetFloatArray LocationsX;
+	FTargetFloatArray LocationsY;
+	FTargetFloatArray LocationsZ;
+	FTargetFloatArray Threats;			// 1 while the target is in combat with the player, 0 otherwise
+
+	// Filled by the kernel
+	FTargetFloatArray DistancesSqr;		// Squared distance from the origin
+	FTargetFloatArray RightDots;		// Dot product of the origin right vector and the direction to the candidate
+
+	// Filled by scoring policies (see TargetScoringPolicies.h)
+	FTargetFloatArray Recencies;		// 1 if just targeted, fading to 0, only filled when a policy needs it
+	FTargetFloatArray ScreenOffsetsSqr;	// Squared distance from the screen center in NDC (0 to 4), only filled when a policy needs it
+	FTargetFloatArray Scores;
+
+	int32 Num() const { return Actors.Num(); }
+
+	SIZE_T GetAllocatedSize() const {
+		return Actors.GetAllocatedSize() + LocationsX.GetAllocatedSize() + LocationsY.GetAllocatedSize() +
+			LocationsZ.GetAllocatedSize() + Threats.GetAllocatedSize() + DistancesSqr.GetAllocatedSize() +
+			RightDots.GetAllocatedSize() + Recencies.GetAllocatedSize() + ScreenOffsetsSqr.GetAllocatedSize() +
+			Scores.GetAllocatedSize();
+	}
+
+	void Add(AActor* Actor, float X, float Y, float Z, float Threat = 0.0f) {
+		Actors.Add(Actor);
+		LocationsX.Add(X);
+		LocationsY.Add(Y);
+		LocationsZ.Add(Z);
+		Threats.Add(Threat);
+	}
+
+	// Removes a gathered candidate before the kernel runs (order isn't kept)
+	void RemoveAtSwap(int32 Index) {
+		Actors.RemoveAtSwap(Index, EAllowShrinking::No);
+		LocationsX.RemoveAtSwap(Index, EAllowShrinking::No);
+		LocationsY.RemoveAtSwap(Index, EAllowShrinking::No);
+		LocationsZ.RemoveAtSwap(Index, EAllowShrinking::No);
+		Threats.RemoveAtSwap(Index, EAllowShrinking::No);
+	}
+
+	void Reset() {
+		Actors.Reset();
+		LocationsX.Reset();
+		LocationsY.Reset();
+		LocationsZ.Reset();
+		Threats.Reset();
+		DistancesSqr.Reset();
+		RightDots.Reset();
+		Recencies.Reset();
+		ScreenOffsetsSqr.Reset();
+		Scores.Reset();
+	}
+};
+
+
+// Candidate indices chosen by the kernel (INDEX_NONE if no candidate qualifies)
+struct FTargetSelectionResult
+{
+	int32 NearestIndex = INDEX_NONE;
+	int32 SecondNearestIndex = INDEX_NONE;	// Used when the nearest target is the previous target
+	int32 LeftIndex = INDEX_NONE;			// Candidate with the smallest negative right projection
+	int32 RightIndex = INDEX_NONE;			// Candidate with the smallest positive right projection
+
+	TArray<int32, TInlineAllocator<8>> RankedIndices;	// Up to NumRanked nearest candidates, nearest first
+};
+
+
+namespace TargetSelection
+{
+	// Computes squared distances and right projections four candidates at a time,
+	//	then picks nearest, second nearest, left and right in one sweep.
+	//	DirectionalExcludeIndex is skipped for left and right (usually the current target).
+	//	NumRanked nearest candidates are kept in distance order (at least 2, for nearest and second nearest).
+	ENEMYLOCKONTARGETING_API void SelectTargets(FTargetCandidates& Candidates, const FVector& Origin,
+		const FVector& RightVector, float MaxDistanceSqr, int32 DirectionalExcludeIndex, FTargetSelectionResult& OutResult,
+		int32 NumRanked = 2);
+}
@@ -0,0 +1,60 @@
+/*
+* Author: Eyan Martucci
+* Description: Caches line of sight between the player and lock on candidates. Traces are issued
+*	asynchronously and consumed the next frame, results expire after a time to live or when
+*	the player or target moves too far, so target selection never has to trace synchronously.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldCollision.h"			// For FTraceDelegate and FTraceDatum
+#include "UObject/ObjectKey.h"		// For TObjectKey
+
+
+class ENEMYLOCKONTARGETING_API FTargetVisibilityCache
+{
+public:
+
+	float TimeToLive = 0.5f;					// Seconds a trace result stays valid
+	float InvalidateDistance = 50.0f;			// Result is traced again once either end moves this far
+	ECollisionChannel TraceChannel = ECC_Visibility;
+
+	// Marks the actors that should be kept traced (targets in range), other entries are dropped
+	void SetWatchedTargets(TConstArrayView<AActor*> Targets);
+
+	// Starts async traces for watched targets without a valid result. Delegate must outlive the traces (owned by a UObject).
+	void Update(UWorld* World, const FVector& ViewLocation, const AActor* Viewer, FTraceDelegate* Delegate);
+
+	void HandleTraceResult(const FTraceDatum& Datum);	// Call from the delegate passed to Update
+
+	// Returns the cached result, targets that haven't been traced yet count as visible.
+	//	Only for keeping already ranked targets while their next trace is pending, selection uses HasVisibleResult.
+	bool IsVisible(const AActor* Target) const;
+
+	// True only once a trace found the target visible, so a target behind a wall can't be picked the frame it enters range
+	bool HasVisibleResult(const AActor* Target) const;
+
+	uint32 GetVersion() const { return Version; }	// Changes whenever a target's visibility changes or is first traced
+
+private:
+
+	struct FEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		FVector ViewLocation = FVector::ZeroVector;		// Both ends of the last issued trace
+		FVector TargetLocation = FVector::ZeroVector;
+		double TraceTime = 0.0;
+		uint32 PendingTraceId = 0;						// 0 if no trace is in flight
+		bool bHasResult = false;
+		bool bVisible = true;
+		bool bWatched = false;
+	};
+
+	TMap<TObjectKey<AActor>, FEntry> Entries;
+	TMap<uint32, TObjectKey<AActor>> PendingTraces;	// Trace id to the entry waiting for it
+	uint32 NextTraceId = 1;
+	uint32 Version = 0;
+
+	bool NeedsTrace(const FEntry& Entry, const FVector& ViewLocation, double Now) const;
+};
@@ -70,6 +70,8 @@ private:
 	UPROPERTY()
 	APlayerCameraManager* CamManager;
 	UPROPERTY()
+	class UInputLatencySubsystem* InputLatency;	// Records when the arrow first moves to a new lock on target
+	UPROPERTY()
 	float CurVerticalOffset = 0.0f;
 	UPROPERTY()
 	float CurAlpha = 1.0f;